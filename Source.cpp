@@ -90,6 +90,13 @@ const char* fragmentShaderSource = R"(
 const unsigned int SCR_WIDTH = 800;
 const unsigned int SCR_HEIGHT = 600;
 
+// Frame-rate cap; the loop sleeps in glfwWaitEventsTimeout between frames
+const double FRAME_INTERVAL = 1.0 / 60.0;
+
+// Animation speeds in units per second, so they no longer depend on the frame rate
+const float CAMERA_SPEED = 0.5f;  // radians (angle) and units (height) per second
+const float LIGHT_SPEED = 1.0f;   // radians per second
+
 // Camera parameters
 glm::vec3 cameraPos = glm::vec3(0.0f, 0.0f, 5.0f);
 float cameraHeight = 0.0f;
@@ -226,12 +233,12 @@ void createSphere(std::vector<float>& vertices, std::vector<unsigned int>& indic
 }
 
 // Process keyboard input for camera movement
-void processInput(GLFWwindow* window) {
+void processInput(GLFWwindow* window, float deltaTime) {
     if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
         glfwSetWindowShouldClose(window, true);
 
     // Camera controls
-    float cameraSpeed = 0.0005f;
+    float cameraSpeed = CAMERA_SPEED * deltaTime;
     if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
         cameraAngle += cameraSpeed;
     if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
@@ -546,13 +553,23 @@ int main() {
     std::cout << "  M   - Toggle magenta material on/off" << std::endl;
     std::cout << "  ESC - Exit" << std::endl;
 
-    // Render loop
+    // Render loop, capped at one frame per FRAME_INTERVAL
+    double lastFrame = glfwGetTime();
     while (!glfwWindowShouldClose(window)) {
+        // Sleep until the next frame is due; input events are handled meanwhile
+        double now = glfwGetTime();
+        if (now - lastFrame < FRAME_INTERVAL) {
+            glfwWaitEventsTimeout(FRAME_INTERVAL - (now - lastFrame));
+            continue;
+        }
+        float deltaTime = (float)(now - lastFrame);
+        lastFrame = now;
+
         // Input processing
-        processInput(window);
+        processInput(window, deltaTime);
 
         // Update light position (circular animation around origin)
-        lightAngle += 0.001f;
+        lightAngle += LIGHT_SPEED * deltaTime;
         lightPos.x = lightRadius * cos(lightAngle);
         lightPos.z = lightRadius * sin(lightAngle);
 
@@ -0,0 +1,194 @@
+#pragma once
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include "bezier.h"
+
+// Arc-length parameterization of a Bezier curve.
+//
+// The parameter range is cut into equal intervals and the length of each is
+// integrated with 5-point Gauss-Legendre quadrature of the speed |B'(t)|, so
+// the table holds the cumulative length at every interval boundary. The
+// inverse s -> t binary-searches the table and finishes inside one interval
+// with Newton steps on the exact length, O(log intervals) per lookup. Like
+// PowerBasisCurve the table is cached and only rebuilt when the control
+// points differ from the ones it was built for.
+//
+// Evenly spaced samples follow the shape instead of the parameterization:
+// uniform t crowds samples where the curve moves slowly and thins them where
+// it moves fast, so it usually needs more of them to keep the same chord
+// error. The exception is curvature concentrated where the curve is slow,
+// near cusps, which uniform t samples densely for free; compare
+// segmentsForTolerance() with the uniform count before choosing.
+class ArcLengthTable {
+public:
+    static const int NEWTON_STEPS = 3;
+    static const int CURVATURE_SAMPLES = 4; // per interval
+
+    // intervals <= 0 picks a count from the degree
+    void setControlPoints(const float* newPoints, int count, int intervals = 0) {
+        if (intervals <= 0) intervals = std::min(1024, std::max(16, 8 * (count - 1)));
+        if (intervals == intervalCount && count == (int)points.size() / 2 &&
+            std::equal(newPoints, newPoints + 2 * count, points.begin())) {
+            return;
+        }
+        points.assign(newPoints, newPoints + 2 * count);
+        intervalCount = intervals;
+        invalidate();
+    }
+
+    void invalidate() { cached = false; }
+
+    float totalLength() {
+        update();
+        return lengths.empty() ? 0.0f : lengths.back();
+    }
+
+    // Length of the curve from 0 to t
+    float lengthAt(float t) {
+        update();
+        if (lengths.empty()) return 0.0f;
+        t = std::min(1.0f, std::max(0.0f, t));
+        int i = std::min(intervalCount - 1, (int)(t * intervalCount));
+        return lengths[i] + integrate(i / (float)intervalCount, t);
+    }
+
+    // Parameter at which the curve has length s, s clamped to [0, totalLength()]
+    float parameterAt(float s) {
+        update();
+        if (lengths.empty() || s <= 0.0f) return 0.0f;
+        if (s >= lengths.back()) return 1.0f;
+
+        int i = (int)(std::upper_bound(lengths.begin(), lengths.end(), s) - lengths.begin()) - 1;
+        i = std::min(intervalCount - 1, std::max(0, i));
+        float t0 = i / (float)intervalCount, t1 = (i + 1) / (float)intervalCount;
+        float span = lengths[i + 1] - lengths[i];
+        if (span <= 0.0f) return t0;
+
+        // Start from linear interpolation, then Newton: d length / dt = speed
+        float target = s - lengths[i];
+        float t = t0 + (t1 - t0) * (target / span);
+        for (int k = 0; k < NEWTON_STEPS; ++k) {
+            float speed = speedAt(t);
+            if (speed <= 0.0f) break;
+            t = std::min(t1, std::max(t0, t - (integrate(t0, t) - target) / speed));
+        }
+        return t;
+    }
+
+    // Point at distance s along the curve, for constant-speed motion
+    void pointAtLength(float s, float& x, float& y) {
+        float t = parameterAt(s);
+        deCasteljauPoint(points.data(), (int)points.size() / 2, t, scratch.data(), x, y);
+    }
+
+    // segments + 1 parameters at equal arc-length steps, both ends included
+    void evenParameters(int segments, std::vector<float>& ts) {
+        float length = totalLength();
+        ts.resize(segments + 1);
+        for (int k = 0; k <= segments; ++k) {
+            ts[k] = parameterAt(length * k / segments);
+        }
+        ts[0] = 0.0f;
+        ts[segments] = 1.0f;
+    }
+
+    // Segments of equal length whose chords stay within tolerance of the
+    // curve: a chord of length h deviates by about h^2 k / 8 at curvature k
+    int segmentsForTolerance(float tolerance, int minSegments, int maxSegments) {
+        update();
+        float length = totalLength();
+        if (maxCurvature <= 0.0f || length <= 0.0f) return minSegments;
+        float step = std::sqrt(8.0f * tolerance / maxCurvature);
+        int segments = (int)std::min((float)maxSegments, std::ceil(length / step));
+        return std::min(maxSegments, std::max(minSegments, segments));
+    }
+
+    // segments + 1 evenly spaced vertices, interleaved x/y
+    void tessellateEvenly(int segments, std::vector<float>& out) {
+        evenParameters(segments, ts);
+        out.resize(2 * (segments + 1));
+        int count = (int)points.size() / 2;
+        for (int k = 0; k <= segments; ++k) {
+            deCasteljauPoint(points.data(), count, ts[k], scratch.data(), out[k * 2], out[k * 2 + 1]);
+        }
+    }
+
+    int intervals() const { return intervalCount; }
+
+private:
+    std::vector<float> points;
+    int intervalCount = 0;
+    bool cached = false;
+    std::vector<float> lengths;   // cumulative length at t = i / intervalCount
+    std::vector<float> hodograph; // n * (P_i+1 - P_i), interleaved
+    std::vector<float> second;    // hodograph of the hodograph
+    std::vector<float> scratch;
+    std::vector<float> ts;
+    float maxCurvature = 0.0f;
+
+    float speedAt(float t) {
+        float dx, dy;
+        deCasteljauPoint(hodograph.data(), (int)hodograph.size() / 2, t, scratch.data(), dx, dy);
+        return std::sqrt(dx * dx + dy * dy);
+    }
+
+    // Length of the curve between a and b, with a and b in the same interval
+    float integrate(float a, float b) {
+        static const float nodes[5] = { 0.0f, -0.5384693101f, 0.5384693101f, -0.9061798459f, 0.9061798459f };
+        static const float weights[5] = { 0.5688888889f, 0.4786286705f, 0.4786286705f, 0.2369268851f, 0.2369268851f };
+        float half = 0.5f * (b - a), middle = 0.5f * (a + b);
+        float sum = 0.0f;
+        for (int k = 0; k < 5; ++k) {
+            sum += weights[k] * speedAt(middle + half * nodes[k]);
+        }
+        return sum * half;
+    }
+
+    void update() {
+        if (cached) return;
+        cached = true;
+
+        int count = (int)points.size() / 2;
+        int n = count - 1;
+        lengths.clear();
+        maxCurvature = 0.0f;
+        scratch.resize(2 * std::max(count, 1));
+        if (n < 1) return;
+
+        hodograph.resize(2 * n);
+        for (int i = 0; i < n; ++i) {
+            hodograph[i * 2] = n * (points[(i + 1) * 2] - points[i * 2]);
+            hodograph[i * 2 + 1] = n * (points[(i + 1) * 2 + 1] - points[i * 2 + 1]);
+        }
+        second.resize(2 * std::max(n - 1, 1));
+        if (n >= 2) {
+            for (int i = 0; i < n - 1; ++i) {
+                second[i * 2] = (n - 1) * (hodograph[(i + 1) * 2] - hodograph[i * 2]);
+                second[i * 2 + 1] = (n - 1) * (hodograph[(i + 1) * 2 + 1] - hodograph[i * 2 + 1]);
+            }
+        }
+        else {
+            second[0] = second[1] = 0.0f;
+        }
+
+        lengths.resize(intervalCount + 1);
+        lengths[0] = 0.0f;
+        for (int i = 0; i < intervalCount; ++i) {
+            float t0 = i / (float)intervalCount, t1 = (i + 1) / (float)intervalCount;
+            lengths[i + 1] = lengths[i] + integrate(t0, t1);
+        }
+
+        // Curvature |B' x B''| / |B'|^3, sampled CURVATURE_SAMPLES times per interval
+        for (int k = 0; k <= CURVATURE_SAMPLES * intervalCount; ++k) {
+            float t = k / (float)(CURVATURE_SAMPLES * intervalCount);
+            float dx, dy, ddx, ddy;
+            deCasteljauPoint(hodograph.data(), n, t, scratch.data(), dx, dy);
+            deCasteljauPoint(second.data(), std::max(n - 1, 1), t, scratch.data(), ddx, ddy);
+            float speed = std::sqrt(dx * dx + dy * dy);
+            if (speed <= 0.0f) continue;
+            maxCurvature = std::max(maxCurvature, std::fabs(dx * ddy - dy * ddx) / (speed * speed * speed));
+        }
+    }
+};
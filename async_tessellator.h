@@ -0,0 +1,167 @@
+#pragma once
+
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <utility>
+
+// Lets a running job notice that its result is no longer wanted
+class CancelToken {
+public:
+    CancelToken() = default; // never cancelled, for jobs run inline
+    CancelToken(const std::atomic<unsigned>& oldestWantedGeneration, unsigned jobGeneration)
+        : oldestWanted(&oldestWantedGeneration), generation(jobGeneration) {}
+
+    bool cancelled() const {
+        return oldestWanted && static_cast<int>(generation - oldestWanted->load(std::memory_order_relaxed)) < 0;
+    }
+
+private:
+    const std::atomic<unsigned>* oldestWanted = nullptr;
+    unsigned generation = 0;
+};
+
+// Curve rebuilds on one background thread, with double-buffered results.
+//
+// post() takes a job that owns a snapshot of everything it reads. A job that
+// has not started yet is replaced, but a running one is left to finish: it
+// is only ever one job behind the newest, and a drag that posts every frame
+// would otherwise cancel each rebuild and show nothing until it stops. When
+// its result must not be shown at all, post() can supersede it instead; its
+// CancelToken fires and it may return false early. post() also drops a
+// finished result not yet taken, so the caller should take that first if it
+// still wants it. The worker writes into a back buffer and swaps it with the
+// ready buffer once the job is complete, and takeResult() swaps the ready
+// buffer into the caller's, so neither side waits on the other and buffers
+// keep their capacity. The caller keeps drawing its last finished result
+// meanwhile. onReady runs on the worker after every delivered result, e.g.
+// glfwPostEmptyEvent to wake a loop blocked in glfwWaitEvents.
+//
+// State the jobs share with the caller (evaluator scratch, caches) may only
+// be touched by the caller while idle().
+template <typename Result>
+class AsyncTessellator {
+public:
+    // Fills result; returns false when it gave up because token was cancelled
+    using Job = std::function<bool(Result& result, const CancelToken& token)>;
+
+    explicit AsyncTessellator(std::function<void()> readyCallback = nullptr)
+        : onReady(std::move(readyCallback)) {
+        worker = std::thread(&AsyncTessellator::run, this);
+    }
+
+    ~AsyncTessellator() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+            oldestWanted = latest + 1; // cancel whatever is running
+        }
+        wake.notify_one();
+        worker.join();
+    }
+
+    AsyncTessellator(const AsyncTessellator&) = delete;
+    AsyncTessellator& operator=(const AsyncTessellator&) = delete;
+
+    void setReadyCallback(std::function<void()> readyCallback) {
+        std::lock_guard<std::mutex> lock(mutex);
+        onReady = std::move(readyCallback);
+    }
+
+    // Queue job in place of any job not yet started; returns its generation.
+    // supersedeRunning cancels the running job too, e.g. when the canvas was
+    // cleared and its curve must not show up again.
+    unsigned post(Job job, bool supersedeRunning = false) {
+        unsigned generation;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (hasPending) cancelled.fetch_add(1, std::memory_order_relaxed);
+            pending = std::move(job);
+            hasPending = true;
+            hasReady = false;
+            generation = ++latest;
+            if (supersedeRunning) oldestWanted = generation;
+            pendingGeneration = generation;
+        }
+        wake.notify_one();
+        return generation;
+    }
+
+    // Swap the newest finished result into result; false if none arrived since the last call
+    bool takeResult(Result& result) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!hasReady) return false;
+        std::swap(result, ready);
+        hasReady = false;
+        return true;
+    }
+
+    // Nothing queued or running
+    bool idle() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return !running && !hasPending;
+    }
+
+    // Block until idle
+    void wait() {
+        std::unique_lock<std::mutex> lock(mutex);
+        finished.wait(lock, [this] { return !running && !hasPending; });
+    }
+
+    // Jobs superseded before they started or stopped early
+    int cancelledJobs() const { return cancelled.load(std::memory_order_relaxed); }
+
+private:
+    std::thread worker;
+    mutable std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable finished;
+    std::function<void()> onReady;
+    Job pending;
+    bool hasPending = false;
+    unsigned pendingGeneration = 0;
+    bool running = false;
+    bool stopping = false;
+    unsigned latest = 0; // guarded by mutex
+    std::atomic<unsigned> oldestWanted{ 0 };
+    std::atomic<int> cancelled{ 0 };
+    Result back;  // written by the worker only
+    Result ready; // guarded by mutex
+    bool hasReady = false;
+
+    void run() {
+        for (;;) {
+            Job job;
+            unsigned generation;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [this] { return stopping || hasPending; });
+                if (stopping) return;
+                job = std::move(pending);
+                hasPending = false;
+                generation = pendingGeneration;
+                running = true;
+            }
+
+            CancelToken token(oldestWanted, generation);
+            bool complete = job(back, token) && !token.cancelled();
+            std::function<void()> notify;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                running = false;
+                if (complete) {
+                    std::swap(back, ready);
+                    hasReady = true;
+                    notify = onReady;
+                }
+                else {
+                    cancelled.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+            finished.notify_all();
+            if (notify) notify();
+        }
+    }
+};
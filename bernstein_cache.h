@@ -0,0 +1,208 @@
+#pragma once
+
+#include <vector>
+#include <list>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <cstddef>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+#include "bezier.h"
+#include "bezier_simd.h"
+
+// Bernstein basis sampled on a uniform grid t_s = s / (samples - 1).
+// Stored column-major: weights[k * samples + s] = B_k(t_s), so one control
+// point's weights over all samples are contiguous.
+struct BernsteinTable {
+    int degree = 0;
+    int samples = 0;
+    std::vector<float> weights;
+
+    const float* column(int k) const { return weights.data() + (size_t)k * samples; }
+    size_t bytes() const { return weights.size() * sizeof(float); }
+};
+
+inline std::shared_ptr<BernsteinTable> buildBernsteinTable(int degree, int samples) {
+    std::shared_ptr<BernsteinTable> table = std::make_shared<BernsteinTable>();
+    table->degree = degree;
+    table->samples = samples;
+    table->weights.resize((size_t)(degree + 1) * samples);
+
+    // binomial(degree, k) passes DBL_MAX above degree 1029, and (1 - t)^degree
+    // underflows long before that. So each sample starts at its largest
+    // weight, k = round(degree * t), taken from logarithms, and walks out
+    // with the ratio B_k+1 / B_k = t / (1 - t) * (degree - k) / (k + 1); the
+    // far weights shrink towards zero instead of overflowing.
+    std::vector<double> logFactorial(degree + 1);
+    logFactorial[0] = 0.0;
+    for (int i = 1; i <= degree; ++i) {
+        logFactorial[i] = logFactorial[i - 1] + std::log((double)i);
+    }
+
+    double step = samples > 1 ? 1.0 / (samples - 1) : 0.0;
+    for (int s = 0; s < samples; ++s) {
+        double t = s * step;
+        float* weights = table->weights.data() + s;
+        if (t <= 0.0 || t >= 1.0 || degree == 0) {
+            for (int k = 0; k <= degree; ++k) {
+                weights[(size_t)k * samples] = 0.0f;
+            }
+            weights[t >= 1.0 ? (size_t)degree * samples : 0] = 1.0f;
+            continue;
+        }
+        double ratio = t / (1.0 - t);
+        int mode = std::min(degree, (int)(degree * t + 0.5));
+        double peak = std::exp(logFactorial[degree] - logFactorial[mode] - logFactorial[degree - mode] +
+            mode * std::log(t) + (degree - mode) * std::log1p(-t));
+        weights[(size_t)mode * samples] = (float)peak;
+        double weight = peak;
+        for (int k = mode; k < degree; ++k) {
+            weight *= ratio * (degree - k) / (k + 1);
+            weights[(size_t)(k + 1) * samples] = (float)weight;
+        }
+        weight = peak;
+        for (int k = mode; k > 0; --k) {
+            weight *= k / (ratio * (degree - k + 1));
+            weights[(size_t)(k - 1) * samples] = (float)weight;
+        }
+    }
+    return table;
+}
+
+// Lazily built Bernstein tables keyed by (degree, sample count).
+//
+// Curves of the same degree share one table. The cache is bounded by a byte
+// budget and evicts least recently used tables; a table that is still held by
+// a caller stays alive until released. Safe to use from several threads.
+class BernsteinBasisCache {
+public:
+    explicit BernsteinBasisCache(size_t budgetBytes = 32u << 20) : budget(budgetBytes) {}
+
+    std::shared_ptr<const BernsteinTable> get(int degree, int samples) {
+        uint64_t key = ((uint64_t)(uint32_t)degree << 32) | (uint32_t)samples;
+        std::lock_guard<std::mutex> lock(mutex);
+
+        auto found = entries.find(key);
+        if (found != entries.end()) {
+            lru.splice(lru.begin(), lru, found->second.position);
+            return found->second.table;
+        }
+
+        std::shared_ptr<const BernsteinTable> table = buildBernsteinTable(degree, samples);
+        lru.push_front(key);
+        entries[key] = Entry{ table, lru.begin() };
+        usedBytes += table->bytes();
+        evict();
+        return table;
+    }
+
+    void setBudget(size_t budgetBytes) {
+        std::lock_guard<std::mutex> lock(mutex);
+        budget = budgetBytes;
+        evict();
+    }
+
+    size_t bytesInUse() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return usedBytes;
+    }
+
+private:
+    struct Entry {
+        std::shared_ptr<const BernsteinTable> table;
+        std::list<uint64_t>::iterator position;
+    };
+
+    size_t budget;
+    size_t usedBytes = 0;
+    std::list<uint64_t> lru; // most recently used first
+    std::unordered_map<uint64_t, Entry> entries;
+    mutable std::mutex mutex;
+
+    // Drop least recently used tables until within budget, always keeping the newest
+    void evict() {
+        while (usedBytes > budget && lru.size() > 1) {
+            auto victim = entries.find(lru.back());
+            usedBytes -= victim->second.table->bytes();
+            entries.erase(victim);
+            lru.pop_back();
+        }
+    }
+};
+
+inline BernsteinBasisCache& sharedBernsteinCache() {
+    static BernsteinBasisCache cache;
+    return cache;
+}
+
+// Tessellate as a (samples x (n + 1)) * ((n + 1) x 2) matrix product.
+//
+// Samples are processed in blocks whose x/y accumulators stay in L1 while
+// every basis column streams through once; within a block the multiply-add
+// runs across SIMD lanes. out receives table.samples interleaved x/y points.
+inline void tessellateWithBasis(const BernsteinTable& table, const float* points, float* out) {
+    const int SAMPLE_BLOCK = 256;
+    float accX[SAMPLE_BLOCK];
+    float accY[SAMPLE_BLOCK];
+
+    for (int s0 = 0; s0 < table.samples; s0 += SAMPLE_BLOCK) {
+        int length = table.samples - s0 < SAMPLE_BLOCK ? table.samples - s0 : SAMPLE_BLOCK;
+        int vectorLength = length - length % BEZIER_SIMD_WIDTH;
+        for (int s = 0; s < length; ++s) {
+            accX[s] = accY[s] = 0.0f;
+        }
+
+        for (int k = 0; k <= table.degree; ++k) {
+            const float* weights = table.column(k) + s0;
+            float px = points[k * 2];
+            float py = points[k * 2 + 1];
+            SimdFloat vx = simdSet(px);
+            SimdFloat vy = simdSet(py);
+
+            int s = 0;
+            for (; s < vectorLength; s += BEZIER_SIMD_WIDTH) {
+                SimdFloat w = simdLoad(weights + s);
+                simdStore(accX + s, simdMulAdd(w, vx, simdLoad(accX + s)));
+                simdStore(accY + s, simdMulAdd(w, vy, simdLoad(accY + s)));
+            }
+            for (; s < length; ++s) {
+                accX[s] += weights[s] * px;
+                accY[s] += weights[s] * py;
+            }
+        }
+
+        for (int s = 0; s < length; ++s) {
+            out[(s0 + s) * 2] = accX[s];
+            out[(s0 + s) * 2 + 1] = accY[s];
+        }
+    }
+}
+
+// Rank-1 curve update for a single moved control point.
+//
+// A Bezier curve is linear in its control points, so moving P_index by
+// (dx, dy) changes every sample by B_index(t) * (dx, dy). Samples whose change
+// stays below threshold are left alone; [first, last] receives the range that
+// was actually modified. Returns false when nothing changed.
+inline bool applyControlPointDelta(const BernsteinTable& table, int index, float dx, float dy,
+    float* curve, int& first, int& last, float threshold = 1e-7f) {
+    const float* weights = table.column(index);
+    float magnitude = std::fmax(std::fabs(dx), std::fabs(dy));
+    if (magnitude == 0.0f) return false;
+    float minWeight = threshold / magnitude;
+
+    // B_index is unimodal, so the affected samples form one contiguous range
+    first = 0;
+    while (first < table.samples && weights[first] < minWeight) ++first;
+    last = table.samples - 1;
+    while (last >= first && weights[last] < minWeight) --last;
+    if (first > last) return false;
+
+    for (int s = first; s <= last; ++s) {
+        curve[s * 2] += weights[s] * dx;
+        curve[s * 2 + 1] += weights[s] * dy;
+    }
+    return true;
+}
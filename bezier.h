@@ -0,0 +1,65 @@
+#pragma once
+
+#include <vector>
+#include <cmath>
+
+// Shared Bezier helpers. Control points are interleaved x/y floats,
+// the same layout real.cpp keeps in controlPoints.
+
+// Binomial coefficient C(n, k)
+inline double binomial(int n, int k) {
+    if (k < 0 || k > n) return 0.0;
+    if (k > n - k) k = n - k;
+    double result = 1.0;
+    for (int i = 1; i <= k; ++i) {
+        result = result * (n - k + i) / i;
+    }
+    return result;
+}
+
+// De Casteljau's algorithm for a single parameter value.
+// scratch must hold 2 * count floats; nothing is allocated.
+inline void deCasteljauPoint(const float* points, int count, float t, float* scratch, float& outX, float& outY) {
+    for (int i = 0; i < 2 * count; ++i) {
+        scratch[i] = points[i];
+    }
+    float s = 1.0f - t;
+    for (int r = 1; r < count; ++r) {
+        for (int j = 0; j < count - r; ++j) {
+            scratch[j * 2] = s * scratch[j * 2] + t * scratch[(j + 1) * 2];
+            scratch[j * 2 + 1] = s * scratch[j * 2 + 1] + t * scratch[(j + 1) * 2 + 1];
+        }
+    }
+    outX = scratch[0];
+    outY = scratch[1];
+}
+
+// Convert a Bernstein control polygon to power-basis (monomial) coefficients.
+// coeffs receives 2 * count doubles, interleaved x/y, constant term first:
+// a_k = C(n, k) * sum_i (-1)^(k - i) * C(k, i) * P_i
+inline void bezierToPowerBasis(const float* points, int count, double* coeffs) {
+    int n = count - 1;
+    for (int k = 0; k <= n; ++k) {
+        double ax = 0.0, ay = 0.0;
+        for (int i = 0; i <= k; ++i) {
+            double w = binomial(k, i) * (((k - i) & 1) ? -1.0 : 1.0);
+            ax += w * points[i * 2];
+            ay += w * points[i * 2 + 1];
+        }
+        double c = binomial(n, k);
+        coeffs[k * 2] = c * ax;
+        coeffs[k * 2 + 1] = c * ay;
+    }
+}
+
+// Horner evaluation of interleaved power-basis coefficients
+inline void evaluatePowerBasis(const double* coeffs, int count, double t, double& outX, double& outY) {
+    double x = coeffs[(count - 1) * 2];
+    double y = coeffs[(count - 1) * 2 + 1];
+    for (int k = count - 2; k >= 0; --k) {
+        x = x * t + coeffs[k * 2];
+        y = y * t + coeffs[k * 2 + 1];
+    }
+    outX = x;
+    outY = y;
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+// Vertex counts from the last adaptive tessellation
+struct AdaptiveStats {
+    int vertices = 0;
+    int pieces = 0;
+    int maxDepth = 0;
+};
+
+// Distance from (px, py) to the segment (ax, ay)-(bx, by)
+inline float distanceToSegment(float px, float py, float ax, float ay, float bx, float by) {
+    float ex = bx - ax, ey = by - ay;
+    float lengthSq = ex * ex + ey * ey;
+    float u = lengthSq > 0.0f ? ((px - ax) * ex + (py - ay) * ey) / lengthSq : 0.0f;
+    u = u < 0.0f ? 0.0f : (u > 1.0f ? 1.0f : u);
+    float dx = px - (ax + u * ex), dy = py - (ay + u * ey);
+    return std::sqrt(dx * dx + dy * dy);
+}
+
+// A piece is flat when every control point lies within tolerance of its chord.
+// The curve stays inside the control hull, so it is then within tolerance too.
+inline bool isFlat(const float* points, int count, float tolerance) {
+    int n = count - 1;
+    for (int i = 1; i < n; ++i) {
+        if (distanceToSegment(points[i * 2], points[i * 2 + 1],
+            points[0], points[1], points[n * 2], points[n * 2 + 1]) > tolerance) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Split a control polygon at t with De Casteljau. work must hold 2 * count floats;
+// left and right each receive 2 * count floats; either may alias points.
+inline void splitBezier(const float* points, int count, float t, float* left, float* right, float* work) {
+    int n = count - 1;
+    for (int i = 0; i < 2 * count; ++i) {
+        work[i] = points[i];
+    }
+    left[0] = work[0];
+    left[1] = work[1];
+    right[n * 2] = work[n * 2];
+    right[n * 2 + 1] = work[n * 2 + 1];
+    for (int r = 1; r <= n; ++r) {
+        for (int j = 0; j <= n - r; ++j) {
+            work[j * 2] += t * (work[(j + 1) * 2] - work[j * 2]);
+            work[j * 2 + 1] += t * (work[(j + 1) * 2 + 1] - work[j * 2 + 1]);
+        }
+        left[r * 2] = work[0];
+        left[r * 2 + 1] = work[1];
+        right[(n - r) * 2] = work[(n - r) * 2];
+        right[(n - r) * 2 + 1] = work[(n - r) * 2 + 1];
+    }
+}
+
+// Flatness-driven subdivision tessellator.
+//
+// Splits the curve in half until each piece is flat within tolerance and
+// emits one vertex per piece, so near-straight curves collapse to a handful
+// of vertices and detail goes only where the curve bends. Uses an explicit
+// stack whose storage is reused between calls.
+class AdaptiveTessellator {
+public:
+    int maxDepth = 12;
+
+    // Writes an interleaved x/y polyline from the first to the last control point
+    void tessellate(const float* points, int count, float tolerance, std::vector<float>& out) {
+        out.clear();
+        stats = AdaptiveStats();
+        if (count < 2) return;
+
+        int stride = 2 * count;
+        pieces.resize((size_t)(maxDepth + 2) * stride);
+        depths.resize(maxDepth + 2);
+        work.resize(stride);
+
+        out.push_back(points[0]);
+        out.push_back(points[1]);
+
+        // Left halves are pushed last so pieces pop in curve order
+        int top = 0;
+        std::copy(points, points + stride, pieces.begin());
+        depths[0] = 0;
+        while (top >= 0) {
+            float* piece = &pieces[(size_t)top * stride];
+            int depth = depths[top];
+            if (depth >= maxDepth || isFlat(piece, count, tolerance)) {
+                out.push_back(piece[(count - 1) * 2]);
+                out.push_back(piece[(count - 1) * 2 + 1]);
+                stats.pieces++;
+                stats.maxDepth = depth > stats.maxDepth ? depth : stats.maxDepth;
+                --top;
+                continue;
+            }
+
+            float* next = piece + stride;
+            splitBezier(piece, count, 0.5f, next, piece, work.data());
+            depths[top] = depth + 1;
+            depths[top + 1] = depth + 1;
+            ++top;
+        }
+        stats.vertices = (int)out.size() / 2;
+    }
+
+    const AdaptiveStats& lastStats() const { return stats; }
+
+private:
+    std::vector<float> pieces; // stack of control polygons, 2 * count floats each
+    std::vector<int> depths;
+    std::vector<float> work;
+    AdaptiveStats stats;
+};
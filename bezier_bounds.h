@@ -0,0 +1,158 @@
+#pragma once
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include "bezier.h"
+#include "bezier_adaptive.h"
+
+// Axis-aligned box, minX, minY, maxX, maxY
+struct BezierBounds {
+    float minX = 0.0f, minY = 0.0f, maxX = 0.0f, maxY = 0.0f;
+
+    void reset(float x, float y) {
+        minX = maxX = x;
+        minY = maxY = y;
+    }
+
+    void add(float x, float y) {
+        minX = std::min(minX, x);
+        minY = std::min(minY, y);
+        maxX = std::max(maxX, x);
+        maxY = std::max(maxY, y);
+    }
+
+    bool contains(const BezierBounds& other) const {
+        return other.minX >= minX && other.maxX <= maxX && other.minY >= minY && other.maxY <= maxY;
+    }
+
+    bool overlaps(float left, float bottom, float right, float top) const {
+        return maxX >= left && minX <= right && maxY >= bottom && minY <= top;
+    }
+};
+
+inline BezierBounds controlBounds(const float* points, int count) {
+    BezierBounds bounds;
+    bounds.reset(points[0], points[1]);
+    for (int i = 1; i < count; ++i) {
+        bounds.add(points[i * 2], points[i * 2 + 1]);
+    }
+    return bounds;
+}
+
+// Parameters in (0, 1) where one coordinate of a degree <= 3 curve has a
+// zero derivative; axis is 0 for x, 1 for y. Returns the number found.
+inline int bezierExtrema(const float* points, int count, int axis, float* roots) {
+    int n = count - 1;
+    float d[3];
+    for (int i = 0; i < n; ++i) {
+        d[i] = points[(i + 1) * 2 + axis] - points[i * 2 + axis];
+    }
+    int found = 0;
+    if (n == 2) {
+        float denominator = d[0] - d[1];
+        if (denominator != 0.0f) {
+            float t = d[0] / denominator;
+            if (t > 0.0f && t < 1.0f) roots[found++] = t;
+        }
+    }
+    else if (n == 3) {
+        // d0 (1-t)^2 + 2 d1 t (1-t) + d2 t^2 = a t^2 + b t + c
+        float a = d[0] - 2.0f * d[1] + d[2];
+        float b = 2.0f * (d[1] - d[0]);
+        float c = d[0];
+        if (std::fabs(a) < 1e-12f) {
+            if (b != 0.0f) {
+                float t = -c / b;
+                if (t > 0.0f && t < 1.0f) roots[found++] = t;
+            }
+        }
+        else {
+            float discriminant = b * b - 4.0f * a * c;
+            if (discriminant >= 0.0f) {
+                // Citardauq form avoids cancellation in the smaller root
+                float q = -0.5f * (b + std::copysign(std::sqrt(discriminant), b));
+                float candidates[2] = { q / a, q != 0.0f ? c / q : -1.0f };
+                for (float t : candidates) {
+                    if (t > 0.0f && t < 1.0f) roots[found++] = t;
+                }
+            }
+        }
+    }
+    return found;
+}
+
+// Exact bounding box of a Bezier curve.
+//
+// Up to cubics the extrema come from the roots of the derivative. Higher
+// degrees are subdivided: pieces whose control box already lies inside the
+// box found so far are dropped, the rest are halved, and pieces smaller than
+// tolerance add their control box, so the result is never too small and at
+// most tolerance too large.
+inline BezierBounds bezierBounds(const float* points, int count, float tolerance = 1e-5f) {
+    BezierBounds bounds;
+    bounds.reset(points[0], points[1]);
+    bounds.add(points[(count - 1) * 2], points[(count - 1) * 2 + 1]);
+    if (count <= 2) return bounds;
+
+    float scratch[8];
+    if (count <= 4) {
+        for (int axis = 0; axis < 2; ++axis) {
+            float roots[2];
+            int found = bezierExtrema(points, count, axis, roots);
+            for (int i = 0; i < found; ++i) {
+                float x, y;
+                deCasteljauPoint(points, count, roots[i], scratch, x, y);
+                bounds.add(x, y);
+            }
+        }
+        return bounds;
+    }
+
+    const int maxDepth = 16;
+    int stride = 2 * count;
+    std::vector<float> pieces((size_t)(maxDepth + 2) * stride);
+    std::vector<int> depths(maxDepth + 2);
+    std::vector<float> work(stride);
+    std::copy(points, points + stride, pieces.begin());
+    depths[0] = 0;
+    int top = 0;
+    while (top >= 0) {
+        float* piece = &pieces[(size_t)top * stride];
+        BezierBounds hull = controlBounds(piece, count);
+        if (bounds.contains(hull)) {
+            --top;
+            continue;
+        }
+        if (depths[top] >= maxDepth || std::max(hull.maxX - hull.minX, hull.maxY - hull.minY) < tolerance) {
+            bounds.add(hull.minX, hull.minY);
+            bounds.add(hull.maxX, hull.maxY);
+            --top;
+            continue;
+        }
+        float* next = piece + stride;
+        splitBezier(piece, count, 0.5f, next, piece, work.data());
+        bounds.add(piece[0], piece[1]);
+        depths[top + 1] = ++depths[top];
+        ++top;
+    }
+    return bounds;
+}
+
+// Segments needed for a uniform polyline to stay within tolerancePixels of
+// the curve once drawn. The chord error of a step h is at most h^2 |B''| / 8
+// and |B''| <= n (n - 1) max |P_i+2 - 2 P_i+1 + P_i|, measured here in pixels
+// with pixelsX and pixelsY pixels per world unit.
+inline int bezierSegmentsForTolerance(const float* points, int count, float pixelsX, float pixelsY,
+    float tolerancePixels, int minSegments, int maxSegments) {
+    int n = count - 1;
+    float maxSecondDifference = 0.0f;
+    for (int i = 0; i + 2 <= n; ++i) {
+        float dx = (points[(i + 2) * 2] - 2.0f * points[(i + 1) * 2] + points[i * 2]) * pixelsX;
+        float dy = (points[(i + 2) * 2 + 1] - 2.0f * points[(i + 1) * 2 + 1] + points[i * 2 + 1]) * pixelsY;
+        maxSecondDifference = std::max(maxSecondDifference, std::sqrt(dx * dx + dy * dy));
+    }
+    float bound = n * (n - 1) * maxSecondDifference;
+    int segments = (int)std::ceil(std::sqrt(bound / (8.0f * tolerancePixels)));
+    return std::min(maxSegments, std::max(minSegments, segments));
+}
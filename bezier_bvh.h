@@ -0,0 +1,218 @@
+#pragma once
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include "bezier_adaptive.h"
+#include "bezier_bounds.h"
+
+// Closest point found on a curve
+struct CurveHit {
+    bool found = false;
+    float t = 0.0f;        // curve index + local parameter, see BezierBvh
+    float distance = 0.0f;
+    float x = 0.0f, y = 0.0f;
+};
+
+// Point, first and second derivative of a Bezier at t. scratch holds 2 * count floats.
+inline void bezierDerivatives(const float* points, int count, float t, float* scratch, float* p, float* d1, float* d2) {
+    int n = count - 1;
+    if (n < 2) {
+        for (int c = 0; c < 2; ++c) {
+            float a = points[c], b = n == 1 ? points[2 + c] : a;
+            p[c] = a + t * (b - a);
+            d1[c] = b - a;
+            d2[c] = 0.0f;
+        }
+        return;
+    }
+    for (int i = 0; i < 2 * count; ++i) {
+        scratch[i] = points[i];
+    }
+    // Stop at the quadratic level: its three points give both derivatives
+    for (int r = 1; r <= n - 2; ++r) {
+        for (int j = 0; j <= n - r; ++j) {
+            scratch[j * 2] += t * (scratch[(j + 1) * 2] - scratch[j * 2]);
+            scratch[j * 2 + 1] += t * (scratch[(j + 1) * 2 + 1] - scratch[j * 2 + 1]);
+        }
+    }
+    for (int c = 0; c < 2; ++c) {
+        float q0 = scratch[c], q1 = scratch[2 + c], q2 = scratch[4 + c];
+        float r0 = q0 + t * (q1 - q0), r1 = q1 + t * (q2 - q1);
+        p[c] = r0 + t * (r1 - r0);
+        d1[c] = n * (r1 - r0);
+        d2[c] = n * (n - 1) * (q2 - 2.0f * q1 + q0);
+    }
+}
+
+// Bounding-volume hierarchy for closest-point queries on Bezier curves.
+//
+// Each curve is cut into equal-parameter pieces with De Casteljau; the pieces
+// are the leaves and are boxed by their control hulls, which contain them.
+// Leaves stay in curve order, so halving index ranges gives a balanced tree
+// of spatially coherent boxes. A query walks the tree nearest box first,
+// skips every box farther than the best hit so far, and refines each leaf it
+// reaches by sampling it and polishing with Newton's method on
+// (B(t) - p) . B'(t) = 0. Only a few leaves survive the pruning, so queries
+// take microseconds however long the curve is.
+//
+// A chain of curves (e.g. the segments of a composite curve) can share one
+// hierarchy; hit parameters are then curve index + local t.
+class BezierBvh {
+public:
+    static const int NEWTON_STEPS = 4;
+    static const int LEAF_SAMPLES = 4; // spans sampled before polishing
+
+    // Index one curve; pieces <= 0 picks a count from the degree
+    void build(const float* points, int count, int pieces = 0) {
+        if (pieces <= 0) pieces = std::min(256, std::max(4, 4 * (count - 1)));
+        buildChain(points, 1, count, pieces);
+    }
+
+    // Index curveCount curves of count points each, stored back to back
+    void buildChain(const float* curves, int curveCount, int count, int piecesPerCurve) {
+        pointCount = count;
+        int stride = 2 * count;
+        int leaves = curveCount * piecesPerCurve;
+        leafPoints.resize((size_t)leaves * stride);
+        leafStart.resize(leaves);
+        leafSpan.resize(leaves);
+        nodes.clear();
+        scratch.resize(stride);
+        if (count < 2 || leaves == 0) return;
+
+        std::vector<float> remaining(stride), work(stride);
+        int leaf = 0;
+        for (int c = 0; c < curveCount; ++c) {
+            std::copy(curves + (size_t)c * stride, curves + (size_t)(c + 1) * stride, remaining.begin());
+            for (int k = 0; k < piecesPerCurve; ++k, ++leaf) {
+                float* piece = &leafPoints[(size_t)leaf * stride];
+                // Cutting what remains at 1 / (pieces left) gives equal parameter steps
+                if (k < piecesPerCurve - 1) {
+                    splitBezier(remaining.data(), count, 1.0f / (piecesPerCurve - k), piece, remaining.data(), work.data());
+                }
+                else {
+                    std::copy(remaining.begin(), remaining.end(), piece);
+                }
+                leafStart[leaf] = c + k / (float)piecesPerCurve;
+                leafSpan[leaf] = 1.0f / piecesPerCurve;
+            }
+        }
+        nodes.reserve(2 * leaves);
+        buildNode(0, leaves);
+    }
+
+    int leafCount() const { return (int)leafStart.size(); }
+
+    // Closest point of the indexed curves to (x, y), if one lies within maxDistance
+    CurveHit closestPoint(float x, float y, float maxDistance = INFINITY) const {
+        CurveHit hit;
+        if (nodes.empty()) return hit;
+        float bestSq = maxDistance * maxDistance;
+
+        int stack[64];
+        int top = 0;
+        stack[top++] = 0;
+        while (top > 0) {
+            const Node& node = nodes[stack[--top]];
+            if (boxDistanceSq(node.bounds, x, y) > bestSq) continue;
+            if (node.leaf >= 0) {
+                refineLeaf(node.leaf, x, y, bestSq, hit);
+                continue;
+            }
+            // Push the farther child first so the nearer one is searched first
+            int nearChild = node.first, farChild = node.second;
+            if (boxDistanceSq(nodes[farChild].bounds, x, y) < boxDistanceSq(nodes[nearChild].bounds, x, y)) {
+                std::swap(nearChild, farChild);
+            }
+            stack[top++] = farChild;
+            stack[top++] = nearChild;
+        }
+        if (hit.found) hit.distance = std::sqrt(bestSq);
+        return hit;
+    }
+
+private:
+    struct Node {
+        BezierBounds bounds;
+        int leaf = -1;              // leaf index, or -1 for inner nodes
+        int first = 0, second = 0;  // children of inner nodes
+    };
+
+    int pointCount = 0;
+    std::vector<float> leafPoints; // 2 * pointCount floats per leaf
+    std::vector<float> leafStart;  // parameter of each leaf's start
+    std::vector<float> leafSpan;
+    std::vector<Node> nodes;       // nodes[0] is the root
+    mutable std::vector<float> scratch;
+
+    int buildNode(int begin, int end) {
+        int index = (int)nodes.size();
+        nodes.emplace_back();
+        if (end - begin == 1) {
+            nodes[index].bounds = controlBounds(&leafPoints[(size_t)begin * 2 * pointCount], pointCount);
+            nodes[index].leaf = begin;
+            return index;
+        }
+        int middle = (begin + end) / 2;
+        int first = buildNode(begin, middle);
+        int second = buildNode(middle, end);
+        Node& node = nodes[index];
+        node.first = first;
+        node.second = second;
+        node.bounds = nodes[first].bounds;
+        node.bounds.add(nodes[second].bounds.minX, nodes[second].bounds.minY);
+        node.bounds.add(nodes[second].bounds.maxX, nodes[second].bounds.maxY);
+        return index;
+    }
+
+    static float boxDistanceSq(const BezierBounds& box, float x, float y) {
+        float dx = std::max(0.0f, std::max(box.minX - x, x - box.maxX));
+        float dy = std::max(0.0f, std::max(box.minY - y, y - box.maxY));
+        return dx * dx + dy * dy;
+    }
+
+    float distanceSqAt(const float* piece, float u, float x, float y, float* p) const {
+        float d1[2], d2[2];
+        bezierDerivatives(piece, pointCount, u, scratch.data(), p, d1, d2);
+        return (p[0] - x) * (p[0] - x) + (p[1] - y) * (p[1] - y);
+    }
+
+    void refineLeaf(int leaf, float x, float y, float& bestSq, CurveHit& hit) const {
+        const float* piece = &leafPoints[(size_t)leaf * 2 * pointCount];
+
+        // Coarse samples pick the basin, Newton finds the minimum inside it
+        float u = 0.0f, p[2];
+        float uBestSq = INFINITY;
+        for (int k = 0; k <= LEAF_SAMPLES; ++k) {
+            float d = distanceSqAt(piece, k / (float)LEAF_SAMPLES, x, y, p);
+            if (d < uBestSq) {
+                uBestSq = d;
+                u = k / (float)LEAF_SAMPLES;
+            }
+        }
+        float sampleU = u;
+        for (int i = 0; i < NEWTON_STEPS; ++i) {
+            float d1[2], d2[2];
+            bezierDerivatives(piece, pointCount, u, scratch.data(), p, d1, d2);
+            float ex = p[0] - x, ey = p[1] - y;
+            float g = ex * d1[0] + ey * d1[1];
+            float dg = d1[0] * d1[0] + d1[1] * d1[1] + ex * d2[0] + ey * d2[1];
+            if (dg <= 0.0f) break;
+            u = std::min(1.0f, std::max(0.0f, u - g / dg));
+        }
+        float d = distanceSqAt(piece, u, x, y, p);
+        if (d > uBestSq) {
+            // Newton left the basin; fall back to the best sample
+            u = sampleU;
+            d = distanceSqAt(piece, u, x, y, p);
+        }
+        if (d <= bestSq) {
+            bestSq = d;
+            hit.found = true;
+            hit.t = leafStart[leaf] + u * leafSpan[leaf];
+            hit.x = p[0];
+            hit.y = p[1];
+        }
+    }
+};
@@ -0,0 +1,433 @@
+#pragma once
+
+#include <vector>
+#include <cmath>
+#include <cfloat>
+#include <algorithm>
+#include "bezier_adaptive.h"
+#include "bezier_bounds.h"
+
+// A Bezier curve stored elsewhere, count interleaved x/y points
+struct CurveRef {
+    const float* points = nullptr;
+    int count = 0;
+};
+
+// One intersection: curve indices, parameters on each and the point.
+// For curve-line queries curveB is -1 and tB the parameter along the segment.
+struct CurveIntersection {
+    int curveA = 0, curveB = 0;
+    float tA = 0.0f, tB = 0.0f;
+    float x = 0.0f, y = 0.0f;
+};
+
+// Intersections of Bezier curves with each other and with line segments.
+//
+// The narrow phase subdivides with De Casteljau: a pair of pieces whose
+// control boxes miss each other cannot intersect and is dropped, otherwise
+// the larger piece is halved, until both are smaller than tolerance and the
+// pair is reported. Only the pieces around actual crossings survive, so the
+// work is a few pairs per level and intersection. Curve-line queries use
+// the same idea on the signed distances of the control points to the line.
+// Reported points are polished with Newton's method, which collapses the run
+// of boxes a shallow crossing leaves behind, and reports closer than twice
+// the tolerance are merged.
+//
+// Curve sets first go through a sweep-and-prune broad phase over the
+// curves' control boxes sorted by x, so only curves whose boxes overlap are
+// handed to the narrow phase: the cost follows the number of nearby pairs,
+// not the square of the number of curves.
+//
+// Overlapping curves have no isolated intersections; MAX_STEPS caps the work
+// each pair may cause and lastTruncated() reports it.
+//
+// A tolerance finer than float coordinates can resolve (a fraction of a
+// pixel at high zoom) is raised to 8 ulps of the curves' extent: below that
+// the boxes and Newton's points are round-off, and one crossing would come
+// out as a cluster of reports that no longer merge.
+class BezierIntersector {
+public:
+    static const int MAX_DEPTH = 48;
+    static const int MAX_STEPS = 1 << 16;
+    static const int POLISH_STEPS = 4;
+
+    // Intersections of curves a and b, appended to out
+    void intersect(const float* a, int countA, const float* b, int countB, float tolerance,
+        std::vector<CurveIntersection>& out) {
+        steps = 0;
+        truncated = false;
+        tolerance = std::max(resolvableTolerance(controlBounds(a, countA), tolerance),
+            resolvableTolerance(controlBounds(b, countB), tolerance));
+        narrowPhase(a, countA, b, countB, tolerance, 0, 1, out);
+    }
+
+    // Intersections of a curve with the segment (x0, y0)-(x1, y1), appended to out
+    void intersectLine(const float* points, int count, float x0, float y0, float x1, float y1, float tolerance,
+        std::vector<CurveIntersection>& out) {
+        steps = 0;
+        truncated = false;
+        float dx = x1 - x0, dy = y1 - y0;
+        float lengthSq = dx * dx + dy * dy;
+        if (count < 2 || lengthSq == 0.0f) return;
+        tolerance = resolvableTolerance(controlBounds(points, count), tolerance);
+        size_t first = out.size();
+        int stride = 2 * count;
+        work.resize(stride);
+        piecesA.resize((size_t)(MAX_DEPTH + 2) * stride);
+        ranges.resize(MAX_DEPTH + 2);
+        std::copy(points, points + stride, piecesA.begin());
+        ranges[0] = { 0.0f, 1.0f, 0.0f, 0.0f, 0 };
+        int top = 0;
+        while (top >= 0) {
+            float* piece = &piecesA[(size_t)top * stride];
+            Range range = ranges[top];
+
+            // Signed distance to the line and position along it are both
+            // Bernstein coefficients, so the hull rules out a root if all
+            // distances share a sign or all positions fall off the segment
+            bool above = false, below = false, beforeEnd = false, afterStart = false;
+            for (int i = 0; i < count; ++i) {
+                float px = piece[i * 2] - x0, py = piece[i * 2 + 1] - y0;
+                float cross = dx * py - dy * px;
+                float along = (dx * px + dy * py) / lengthSq;
+                above |= cross >= 0.0f;
+                below |= cross <= 0.0f;
+                afterStart |= along >= 0.0f;
+                beforeEnd |= along <= 1.0f;
+            }
+            if (!above || !below || !afterStart || !beforeEnd) {
+                --top;
+                continue;
+            }
+            if (++steps > MAX_STEPS) {
+                truncated = true;
+                break;
+            }
+            BezierBounds box = controlBounds(piece, count);
+            if (range.depth >= MAX_DEPTH || std::max(box.maxX - box.minX, box.maxY - box.minY) <= tolerance) {
+                CurveIntersection hit;
+                hit.curveA = 0;
+                hit.curveB = -1;
+                hit.tA = 0.5f * (range.a0 + range.a1);
+                hit.x = 0.5f * (box.minX + box.maxX);
+                hit.y = 0.5f * (box.minY + box.maxY);
+                if (coveredHit(hit, first, tolerance, out)) {
+                    --top;
+                    continue;
+                }
+                polishLine(points, count, x0, y0, dx, dy, tolerance, hit);
+                hit.tB = std::min(1.0f, std::max(0.0f, (dx * (hit.x - x0) + dy * (hit.y - y0)) / lengthSq));
+                addHit(hit, first, tolerance, out);
+                --top;
+                continue;
+            }
+            // Left half on top, so roots come out in order of t
+            float middle = 0.5f * (range.a0 + range.a1);
+            float* next = piece + stride;
+            splitBezier(piece, count, 0.5f, next, piece, work.data());
+            ranges[top] = { middle, range.a1, 0.0f, 0.0f, range.depth + 1 };
+            ranges[top + 1] = { range.a0, middle, 0.0f, 0.0f, range.depth + 1 };
+            ++top;
+        }
+    }
+
+    // All intersections between different curves of the set, appended to out
+    // with curveA < curveB. With chained set, curve i ends where curve i + 1
+    // starts (the pieces of a spline) and that shared point is not reported;
+    // neither is any crossing of the two less than one curve apart along the
+    // chain, which takes curves too short to loop on themselves.
+    void intersectSet(const std::vector<CurveRef>& curves, float tolerance, std::vector<CurveIntersection>& out,
+        bool chained = false) {
+        steps = 0;
+        truncated = false;
+        pairsTested = 0;
+        int curveCount = (int)curves.size();
+        boxes.resize(curveCount);
+        order.resize(curveCount);
+        for (int i = 0; i < curveCount; ++i) {
+            boxes[i] = controlBounds(curves[i].points, curves[i].count);
+            order[i] = i;
+            tolerance = resolvableTolerance(boxes[i], tolerance);
+        }
+        std::sort(order.begin(), order.end(), [this](int a, int b) { return boxes[a].minX < boxes[b].minX; });
+
+        // Sweep left to right; active holds the curves whose x range is still open
+        active.clear();
+        for (int i : order) {
+            const BezierBounds& box = boxes[i];
+            for (size_t k = 0; k < active.size();) {
+                int j = active[k];
+                if (boxes[j].maxX < box.minX) {
+                    active[k] = active.back();
+                    active.pop_back();
+                    continue;
+                }
+                ++k;
+                if (boxes[j].maxY < box.minY || boxes[j].minY > box.maxY) continue;
+
+                int a = std::min(i, j), b = std::max(i, j);
+                ++pairsTested;
+                size_t first = out.size();
+                narrowPhase(curves[a].points, curves[a].count, curves[b].points, curves[b].count, tolerance, a, b, out);
+                if (chained && b == a + 1) {
+                    dropJoin(first, out);
+                }
+            }
+            active.push_back(i);
+        }
+    }
+
+    // Points where a chain of curveCount curves of count points each
+    // (stored back to back, each starting where the previous one ends)
+    // crosses itself, appended to out. Every curve is cut into
+    // piecesPerCurve equal-parameter pieces first, which must be short enough
+    // not to loop on themselves. Parameters are curve index + local t, with
+    // tA < tB.
+    void selfIntersections(const float* curves, int curveCount, int count, int piecesPerCurve, float tolerance,
+        std::vector<CurveIntersection>& out) {
+        int stride = 2 * count;
+        int pieceCount = curveCount * piecesPerCurve;
+        selfPieces.resize((size_t)pieceCount * stride);
+        std::vector<float> remaining(stride), scratch(stride);
+        for (int c = 0; c < curveCount; ++c) {
+            std::copy(curves + (size_t)c * stride, curves + (size_t)(c + 1) * stride, remaining.begin());
+            for (int k = 0; k < piecesPerCurve; ++k) {
+                float* piece = &selfPieces[(size_t)(c * piecesPerCurve + k) * stride];
+                if (k < piecesPerCurve - 1) {
+                    splitBezier(remaining.data(), count, 1.0f / (piecesPerCurve - k), piece, remaining.data(), scratch.data());
+                }
+                else {
+                    std::copy(remaining.begin(), remaining.end(), piece);
+                }
+            }
+        }
+        refs.resize(pieceCount);
+        for (int i = 0; i < pieceCount; ++i) {
+            refs[i].points = &selfPieces[(size_t)i * stride];
+            refs[i].count = count;
+        }
+
+        // Raised here as intersectSet would, so the merge below uses the same tolerance
+        tolerance = resolvableTolerance(controlBounds(curves, curveCount * count), tolerance);
+        size_t first = out.size();
+        intersectSet(refs, tolerance, out, true);
+        for (size_t k = first; k < out.size(); ++k) {
+            CurveIntersection& hit = out[k];
+            hit.tA = (hit.curveA + hit.tA) / piecesPerCurve;
+            hit.tB = (hit.curveB + hit.tB) / piecesPerCurve;
+            hit.curveA = std::min(curveCount - 1, (int)hit.tA);
+            hit.curveB = std::min(curveCount - 1, (int)hit.tB);
+        }
+        // A crossing on a piece boundary is found from both pieces
+        mergeHits(first, tolerance, out);
+    }
+
+    int lastSteps() const { return steps; }
+    int lastPairsTested() const { return pairsTested; }
+    bool lastTruncated() const { return truncated; }
+
+private:
+    struct Range {
+        float a0, a1, b0, b1;
+        int depth;
+    };
+
+    int steps = 0;
+    int pairsTested = 0;
+    bool truncated = false;
+    std::vector<float> piecesA, piecesB; // stacks of control polygons
+    std::vector<Range> ranges;
+    std::vector<float> work;
+    std::vector<double> scratchA, scratchB;
+    std::vector<BezierBounds> boxes;
+    std::vector<int> order, active;
+    std::vector<float> selfPieces;
+    std::vector<CurveRef> refs;
+
+    void narrowPhase(const float* a, int countA, const float* b, int countB, float tolerance, int curveA, int curveB,
+        std::vector<CurveIntersection>& out) {
+        if (countA < 2 || countB < 2) return;
+        size_t first = out.size();
+        int strideA = 2 * countA, strideB = 2 * countB;
+        // Each level replaces one entry with two, so the stack never exceeds MAX_DEPTH + 2
+        piecesA.resize((size_t)(MAX_DEPTH + 2) * strideA);
+        piecesB.resize((size_t)(MAX_DEPTH + 2) * strideB);
+        ranges.resize(MAX_DEPTH + 2);
+        work.resize(std::max(strideA, strideB));
+        std::copy(a, a + strideA, piecesA.begin());
+        std::copy(b, b + strideB, piecesB.begin());
+        ranges[0] = { 0.0f, 1.0f, 0.0f, 1.0f, 0 };
+        int top = 0;
+        int pairSteps = 0;
+        while (top >= 0) {
+            float* pieceA = &piecesA[(size_t)top * strideA];
+            float* pieceB = &piecesB[(size_t)top * strideB];
+            Range range = ranges[top];
+            BezierBounds boxA = controlBounds(pieceA, countA);
+            BezierBounds boxB = controlBounds(pieceB, countB);
+            if (!boxA.overlaps(boxB.minX, boxB.minY, boxB.maxX, boxB.maxY)) {
+                --top;
+                continue;
+            }
+            ++steps;
+            if (++pairSteps > MAX_STEPS) {
+                truncated = true;
+                break;
+            }
+            float sizeA = std::max(boxA.maxX - boxA.minX, boxA.maxY - boxA.minY);
+            float sizeB = std::max(boxB.maxX - boxB.minX, boxB.maxY - boxB.minY);
+            if (range.depth >= MAX_DEPTH || (sizeA <= tolerance && sizeB <= tolerance)) {
+                CurveIntersection hit;
+                hit.curveA = curveA;
+                hit.curveB = curveB;
+                hit.tA = 0.5f * (range.a0 + range.a1);
+                hit.tB = 0.5f * (range.b0 + range.b1);
+                hit.x = 0.25f * (boxA.minX + boxA.maxX + boxB.minX + boxB.maxX);
+                hit.y = 0.25f * (boxA.minY + boxA.maxY + boxB.minY + boxB.maxY);
+                // Neighbours of a crossing already reported need no polishing
+                if (!coveredHit(hit, first, tolerance, out)) {
+                    polish(a, countA, b, countB, tolerance, hit);
+                    addHit(hit, first, tolerance, out);
+                }
+                --top;
+                continue;
+            }
+
+            // Halve the larger piece; the other is copied along unchanged
+            Range left = range, right = range;
+            left.depth = right.depth = range.depth + 1;
+            float* nextA = pieceA + strideA;
+            float* nextB = pieceB + strideB;
+            if (sizeA >= sizeB) {
+                float middle = 0.5f * (range.a0 + range.a1);
+                splitBezier(pieceA, countA, 0.5f, nextA, pieceA, work.data());
+                std::copy(pieceB, pieceB + strideB, nextB);
+                left.a1 = right.a0 = middle;
+            }
+            else {
+                float middle = 0.5f * (range.b0 + range.b1);
+                splitBezier(pieceB, countB, 0.5f, nextB, pieceB, work.data());
+                std::copy(pieceA, pieceA + strideA, nextA);
+                left.b1 = right.b0 = middle;
+            }
+            ranges[top] = right;
+            ranges[top + 1] = left;
+            ++top;
+        }
+    }
+
+    // Point and first derivative at t, in double: float round-off would leave
+    // shallow crossings smeared over many ulps along the curves
+    void evaluate(const float* points, int count, double t, std::vector<double>& scratch, double* p, double* d) {
+        int n = count - 1;
+        scratch.assign(points, points + 2 * count);
+        for (int r = 1; r < n; ++r) {
+            for (int j = 0; j <= n - r; ++j) {
+                scratch[j * 2] += t * (scratch[(j + 1) * 2] - scratch[j * 2]);
+                scratch[j * 2 + 1] += t * (scratch[(j + 1) * 2 + 1] - scratch[j * 2 + 1]);
+            }
+        }
+        for (int c = 0; c < 2; ++c) {
+            p[c] = scratch[c] + t * (scratch[2 + c] - scratch[c]);
+            d[c] = n * (scratch[2 + c] - scratch[c]);
+        }
+    }
+
+    // Newton on A(tA) - B(tB) = 0 from the subdivision's estimate; the hit is
+    // only moved if that converges inside both curves
+    void polish(const float* a, int countA, const float* b, int countB, float tolerance, CurveIntersection& hit) {
+        double s = hit.tA, t = hit.tB;
+        double pa[2], da[2], pb[2], db[2];
+        for (int i = 0; i < POLISH_STEPS; ++i) {
+            evaluate(a, countA, s, scratchA, pa, da);
+            evaluate(b, countB, t, scratchB, pb, db);
+            double fx = pa[0] - pb[0], fy = pa[1] - pb[1];
+            // Jacobian [da, -db]
+            double determinant = db[0] * da[1] - da[0] * db[1];
+            if (determinant == 0.0) return;
+            s -= (db[0] * fy - db[1] * fx) / determinant;
+            t -= (da[0] * fy - da[1] * fx) / determinant;
+            if (s < 0.0 || s > 1.0 || t < 0.0 || t > 1.0) return;
+        }
+        evaluate(a, countA, s, scratchA, pa, da);
+        evaluate(b, countB, t, scratchB, pb, db);
+        double fx = pa[0] - pb[0], fy = pa[1] - pb[1];
+        if (fx * fx + fy * fy > 0.01 * tolerance * tolerance) return;
+        hit.tA = (float)s;
+        hit.tB = (float)t;
+        hit.x = (float)(0.5 * (pa[0] + pb[0]));
+        hit.y = (float)(0.5 * (pa[1] + pb[1]));
+    }
+
+    // Newton on the distance of the curve to the line through (x0, y0) along (dx, dy)
+    void polishLine(const float* points, int count, float x0, float y0, float dx, float dy, float tolerance,
+        CurveIntersection& hit) {
+        double t = hit.tA;
+        double p[2], d[2];
+        for (int i = 0; i < POLISH_STEPS; ++i) {
+            evaluate(points, count, t, scratchA, p, d);
+            double f = dx * (p[1] - y0) - dy * (p[0] - x0);
+            double slope = dx * d[1] - dy * d[0];
+            if (slope == 0.0) return;
+            t -= f / slope;
+            if (t < 0.0 || t > 1.0) return;
+        }
+        evaluate(points, count, t, scratchA, p, d);
+        double f = (dx * (p[1] - y0) - dy * (p[0] - x0)) / std::sqrt((double)dx * dx + (double)dy * dy);
+        if (std::fabs(f) > 0.1 * tolerance) return;
+        hit.tA = (float)t;
+        hit.x = (float)p[0];
+        hit.y = (float)p[1];
+    }
+
+    // tolerance, or the finest distance float coordinates within box resolve
+    static float resolvableTolerance(const BezierBounds& box, float tolerance) {
+        float extent = std::max(std::max(std::fabs(box.minX), std::fabs(box.maxX)),
+            std::max(std::fabs(box.minY), std::fabs(box.maxY)));
+        extent = std::max(extent, std::max(box.maxX - box.minX, box.maxY - box.minY));
+        return std::max(tolerance, 8.0f * FLT_EPSILON * extent);
+    }
+
+    static bool sameHit(const CurveIntersection& a, const CurveIntersection& b, float tolerance) {
+        float dx = a.x - b.x, dy = a.y - b.y;
+        return a.curveA == b.curveA && a.curveB == b.curveB && dx * dx + dy * dy <= 4.0f * tolerance * tolerance;
+    }
+
+    // Whether a report since first already covers hit
+    static bool coveredHit(const CurveIntersection& hit, size_t first, float tolerance,
+        const std::vector<CurveIntersection>& out) {
+        for (size_t k = first; k < out.size(); ++k) {
+            if (sameHit(out[k], hit, tolerance)) return true;
+        }
+        return false;
+    }
+
+    static void addHit(const CurveIntersection& hit, size_t first, float tolerance, std::vector<CurveIntersection>& out) {
+        if (!coveredHit(hit, first, tolerance, out)) out.push_back(hit);
+    }
+
+    static void mergeHits(size_t first, float tolerance, std::vector<CurveIntersection>& out) {
+        size_t kept = first;
+        for (size_t k = first; k < out.size(); ++k) {
+            bool duplicate = false;
+            for (size_t j = first; j < kept && !duplicate; ++j) {
+                float dx = out[j].x - out[k].x, dy = out[j].y - out[k].y;
+                duplicate = dx * dx + dy * dy <= 4.0f * tolerance * tolerance;
+            }
+            if (!duplicate) out[kept++] = out[k];
+        }
+        out.resize(kept);
+    }
+
+    // Remove reports since first between curve a and the next one in a chain
+    // that lie less than one curve apart along it, (1 - tA) + tB < 1: the join
+    // itself and the round-off around it. Judged by parameter, since near the
+    // join any distance test is at the mercy of the tolerance.
+    static void dropJoin(size_t first, std::vector<CurveIntersection>& out) {
+        size_t kept = first;
+        for (size_t k = first; k < out.size(); ++k) {
+            if (out[k].tB >= out[k].tA) out[kept++] = out[k];
+        }
+        out.resize(kept);
+    }
+};
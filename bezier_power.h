@@ -0,0 +1,159 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include "bezier.h"
+#include "bezier_simd.h"
+
+// Power-basis coefficients lose roughly two bits per degree in single
+// precision. Up to degree 7 the Horner error on unit-sized curves stays under
+// 1e-4 (a twentieth of a pixel at 800x600); beyond that the curve is
+// evaluated with De Casteljau instead.
+const int MAX_POWER_BASIS_DEGREE = 7;
+
+// Bezier curve with cached monomial coefficients.
+//
+// setControlPoints() only invalidates the cache when the points actually
+// changed, so repeated evaluation of an unchanged curve (resize, level of
+// detail, export) costs one Horner pass per coordinate. Coefficients of the
+// derivative are cached the same way for tangents. Batch evaluation runs
+// Horner across BEZIER_SIMD_WIDTH samples at once.
+class PowerBasisCurve {
+public:
+    void setControlPoints(const float* newPoints, int count) {
+        if (count == (int)points.size() / 2 && std::equal(newPoints, newPoints + 2 * count, points.begin())) {
+            return;
+        }
+        points.assign(newPoints, newPoints + 2 * count);
+        invalidate();
+    }
+
+    void invalidate() { cached = false; }
+
+    int degree() const { return (int)points.size() / 2 - 1; }
+
+    // False when the accuracy guard routes evaluation through De Casteljau
+    bool usesPowerBasis() const { return degree() >= 1 && degree() <= MAX_POWER_BASIS_DEGREE; }
+
+    void evaluate(float t, float& x, float& y) {
+        update();
+        if (points.empty()) {
+            x = y = 0.0f;
+            return;
+        }
+        if (!usesPowerBasis()) {
+            deCasteljauPoint(points.data(), (int)points.size() / 2, t, scratch.data(), x, y);
+            return;
+        }
+        x = horner(coeffX, t);
+        y = horner(coeffY, t);
+    }
+
+    // First derivative B'(t)
+    void tangent(float t, float& dx, float& dy) {
+        update();
+        if (degree() < 1) {
+            dx = dy = 0.0f;
+            return;
+        }
+        if (!usesPowerBasis()) {
+            // B'(t) = n * sum (P_i+1 - P_i) B_i,n-1(t), evaluated on the hodograph
+            deCasteljauPoint(hodograph.data(), degree(), t, scratch.data(), dx, dy);
+            return;
+        }
+        dx = horner(derivX, t);
+        dy = horner(derivY, t);
+    }
+
+    // Evaluate numT parameter values, writing interleaved x/y to out
+    void evaluateBatch(const float* ts, int numT, float* out) {
+        update();
+        if (!usesPowerBasis()) {
+            for (int i = 0; i < numT; ++i) {
+                evaluate(ts[i], out[i * 2], out[i * 2 + 1]);
+            }
+            return;
+        }
+
+        float bx[BEZIER_SIMD_WIDTH], by[BEZIER_SIMD_WIDTH];
+        int n = degree();
+        int i = 0;
+        for (; i + BEZIER_SIMD_WIDTH <= numT; i += BEZIER_SIMD_WIDTH) {
+            SimdFloat t = simdLoad(ts + i);
+            SimdFloat x = simdSet(coeffX[n]);
+            SimdFloat y = simdSet(coeffY[n]);
+            for (int k = n - 1; k >= 0; --k) {
+                x = simdMulAdd(x, t, simdSet(coeffX[k]));
+                y = simdMulAdd(y, t, simdSet(coeffY[k]));
+            }
+            simdStore(bx, x);
+            simdStore(by, y);
+            for (int lane = 0; lane < BEZIER_SIMD_WIDTH; ++lane) {
+                out[(i + lane) * 2] = bx[lane];
+                out[(i + lane) * 2 + 1] = by[lane];
+            }
+        }
+        for (; i < numT; ++i) {
+            out[i * 2] = horner(coeffX, ts[i]);
+            out[i * 2 + 1] = horner(coeffY, ts[i]);
+        }
+    }
+
+    // Evaluate resolution + 1 samples at t = i / resolution
+    void evaluateUniform(int resolution, float* out) {
+        ts.resize(resolution + 1);
+        for (int i = 0; i <= resolution; ++i) {
+            ts[i] = i / (float)resolution;
+        }
+        evaluateBatch(ts.data(), resolution + 1, out);
+    }
+
+private:
+    std::vector<float> points;
+    bool cached = false;
+    std::vector<float> coeffX, coeffY; // constant term first
+    std::vector<float> derivX, derivY;
+    std::vector<float> hodograph;      // n * (P_i+1 - P_i), interleaved
+    std::vector<float> scratch;
+    std::vector<float> ts;
+
+    static float horner(const std::vector<float>& coeffs, float t) {
+        float result = coeffs.back();
+        for (int k = (int)coeffs.size() - 2; k >= 0; --k) {
+            result = result * t + coeffs[k];
+        }
+        return result;
+    }
+
+    void update() {
+        if (cached) return;
+        cached = true;
+
+        int count = (int)points.size() / 2;
+        int n = count - 1;
+        scratch.resize(2 * count);
+        if (n < 1) return;
+
+        hodograph.resize(2 * n);
+        for (int i = 0; i < n; ++i) {
+            hodograph[i * 2] = n * (points[(i + 1) * 2] - points[i * 2]);
+            hodograph[i * 2 + 1] = n * (points[(i + 1) * 2 + 1] - points[i * 2 + 1]);
+        }
+        if (!usesPowerBasis()) return;
+
+        std::vector<double> coeffs(2 * count);
+        bezierToPowerBasis(points.data(), count, coeffs.data());
+        coeffX.resize(count);
+        coeffY.resize(count);
+        for (int k = 0; k < count; ++k) {
+            coeffX[k] = (float)coeffs[k * 2];
+            coeffY[k] = (float)coeffs[k * 2 + 1];
+        }
+        derivX.resize(n);
+        derivY.resize(n);
+        for (int k = 1; k < count; ++k) {
+            derivX[k - 1] = (float)(k * coeffs[k * 2]);
+            derivY[k - 1] = (float)(k * coeffs[k * 2 + 1]);
+        }
+    }
+};
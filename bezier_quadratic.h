@@ -0,0 +1,99 @@
+#pragma once
+
+#include <vector>
+#include <cmath>
+
+// Quadratic Bezier piece: start, control and end point, interleaved x/y
+const int QUADRATIC_FLOATS = 6;
+
+// Piecewise quadratic approximation of a parametric curve.
+//
+// Each span [t0, t1] is replaced by the quadratic through the curve at t0,
+// the midpoint and t1, and checked against the curve at four interior
+// parameters. Spans that miss by more than tolerance are halved, sharing the
+// split point so neighbouring pieces join exactly. Quadratics are what the
+// distance shaders can solve in closed form, so any degree or basis can be
+// drawn through them.
+class QuadraticApproximator {
+public:
+    int maxDepth = 10;
+
+    void clear() { out.clear(); }
+
+    // Interleaved pieces, QUADRATIC_FLOATS floats each, in curve order
+    const std::vector<float>& quadratics() const { return out; }
+    int quadraticCount() const { return (int)out.size() / QUADRATIC_FLOATS; }
+
+    // Append the approximation of curve(t, x, y) over [t0, t1], starting
+    // from spans equal spans (e.g. the degree, so wiggles are not missed)
+    template <typename Curve>
+    void append(const Curve& curve, float t0, float t1, float tolerance, int spans = 1) {
+        if (spans < 1) spans = 1;
+        float x0, y0;
+        curve(t0, x0, y0);
+        for (int s = 0; s < spans; ++s) {
+            float a = t0 + (t1 - t0) * s / spans;
+            float b = s == spans - 1 ? t1 : t0 + (t1 - t0) * (s + 1) / spans;
+            float x1, y1;
+            curve(b, x1, y1);
+            appendSpan(curve, a, b, x0, y0, x1, y1, tolerance);
+            x0 = x1;
+            y0 = y1;
+        }
+    }
+
+private:
+    struct Span {
+        float t0, t1;
+        float x0, y0, x1, y1;
+        int depth;
+    };
+
+    std::vector<float> out;
+    std::vector<Span> stack;
+
+    template <typename Curve>
+    void appendSpan(const Curve& curve, float t0, float t1, float x0, float y0, float x1, float y1, float tolerance) {
+        static const float checks[4] = { 0.125f, 0.375f, 0.625f, 0.875f };
+        float toleranceSq = tolerance * tolerance;
+
+        // Right halves are pushed first so spans pop in curve order
+        stack.clear();
+        stack.push_back({ t0, t1, x0, y0, x1, y1, 0 });
+        while (!stack.empty()) {
+            Span span = stack.back();
+            stack.pop_back();
+
+            float tm = 0.5f * (span.t0 + span.t1);
+            float mx, my;
+            curve(tm, mx, my);
+            // The control point that puts the quadratic through the midpoint at u = 1/2
+            float cx = 2.0f * mx - 0.5f * (span.x0 + span.x1);
+            float cy = 2.0f * my - 0.5f * (span.y0 + span.y1);
+
+            bool fits = span.depth >= maxDepth;
+            if (!fits) {
+                fits = true;
+                for (float u : checks) {
+                    float x, y;
+                    curve(span.t0 + u * (span.t1 - span.t0), x, y);
+                    float s = 1.0f - u;
+                    float qx = s * s * span.x0 + 2.0f * u * s * cx + u * u * span.x1;
+                    float qy = s * s * span.y0 + 2.0f * u * s * cy + u * u * span.y1;
+                    if ((qx - x) * (qx - x) + (qy - y) * (qy - y) > toleranceSq) {
+                        fits = false;
+                        break;
+                    }
+                }
+            }
+
+            if (fits) {
+                float piece[QUADRATIC_FLOATS] = { span.x0, span.y0, cx, cy, span.x1, span.y1 };
+                out.insert(out.end(), piece, piece + QUADRATIC_FLOATS);
+                continue;
+            }
+            stack.push_back({ tm, span.t1, mx, my, span.x1, span.y1, span.depth + 1 });
+            stack.push_back({ span.t0, tm, span.x0, span.y0, mx, my, span.depth + 1 });
+        }
+    }
+};
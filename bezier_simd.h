@@ -0,0 +1,167 @@
+#pragma once
+
+#include <vector>
+#include "bezier.h"
+
+// Lane-width float vectors. The widest instruction set the compiler is
+// allowed to target is picked at compile time: AVX-512 evaluates 16
+// parameter values per instruction, AVX/AVX2 8 and SSE2 4. Without any of
+// them the "vector" is a single float.
+#if defined(__AVX512F__)
+#include <immintrin.h>
+#define BEZIER_SIMD_WIDTH 16
+#define BEZIER_SIMD_NAME "AVX-512"
+typedef __m512 SimdFloat;
+inline SimdFloat simdLoad(const float* p) { return _mm512_loadu_ps(p); }
+inline void simdStore(float* p, SimdFloat v) { _mm512_storeu_ps(p, v); }
+inline SimdFloat simdSet(float v) { return _mm512_set1_ps(v); }
+inline SimdFloat simdAdd(SimdFloat a, SimdFloat b) { return _mm512_add_ps(a, b); }
+inline SimdFloat simdSub(SimdFloat a, SimdFloat b) { return _mm512_sub_ps(a, b); }
+inline SimdFloat simdMul(SimdFloat a, SimdFloat b) { return _mm512_mul_ps(a, b); }
+inline SimdFloat simdMulAdd(SimdFloat a, SimdFloat b, SimdFloat c) { return _mm512_fmadd_ps(a, b, c); }
+#elif defined(__AVX2__) || defined(__AVX__)
+#include <immintrin.h>
+#define BEZIER_SIMD_WIDTH 8
+#define BEZIER_SIMD_NAME "AVX"
+typedef __m256 SimdFloat;
+inline SimdFloat simdLoad(const float* p) { return _mm256_loadu_ps(p); }
+inline void simdStore(float* p, SimdFloat v) { _mm256_storeu_ps(p, v); }
+inline SimdFloat simdSet(float v) { return _mm256_set1_ps(v); }
+inline SimdFloat simdAdd(SimdFloat a, SimdFloat b) { return _mm256_add_ps(a, b); }
+inline SimdFloat simdSub(SimdFloat a, SimdFloat b) { return _mm256_sub_ps(a, b); }
+inline SimdFloat simdMul(SimdFloat a, SimdFloat b) { return _mm256_mul_ps(a, b); }
+#if defined(__FMA__)
+inline SimdFloat simdMulAdd(SimdFloat a, SimdFloat b, SimdFloat c) { return _mm256_fmadd_ps(a, b, c); }
+#else
+inline SimdFloat simdMulAdd(SimdFloat a, SimdFloat b, SimdFloat c) { return _mm256_add_ps(_mm256_mul_ps(a, b), c); }
+#endif
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define BEZIER_SIMD_WIDTH 4
+#define BEZIER_SIMD_NAME "SSE2"
+typedef __m128 SimdFloat;
+inline SimdFloat simdLoad(const float* p) { return _mm_loadu_ps(p); }
+inline void simdStore(float* p, SimdFloat v) { _mm_storeu_ps(p, v); }
+inline SimdFloat simdSet(float v) { return _mm_set1_ps(v); }
+inline SimdFloat simdAdd(SimdFloat a, SimdFloat b) { return _mm_add_ps(a, b); }
+inline SimdFloat simdSub(SimdFloat a, SimdFloat b) { return _mm_sub_ps(a, b); }
+inline SimdFloat simdMul(SimdFloat a, SimdFloat b) { return _mm_mul_ps(a, b); }
+inline SimdFloat simdMulAdd(SimdFloat a, SimdFloat b, SimdFloat c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+#else
+#define BEZIER_SIMD_WIDTH 1
+#define BEZIER_SIMD_NAME "scalar"
+typedef float SimdFloat;
+inline SimdFloat simdLoad(const float* p) { return *p; }
+inline void simdStore(float* p, SimdFloat v) { *p = v; }
+inline SimdFloat simdSet(float v) { return v; }
+inline SimdFloat simdAdd(SimdFloat a, SimdFloat b) { return a + b; }
+inline SimdFloat simdSub(SimdFloat a, SimdFloat b) { return a - b; }
+inline SimdFloat simdMul(SimdFloat a, SimdFloat b) { return a * b; }
+inline SimdFloat simdMulAdd(SimdFloat a, SimdFloat b, SimdFloat c) { return a * b + c; }
+#endif
+
+// a + t * (b - a), the De Casteljau step
+inline SimdFloat simdLerp(SimdFloat a, SimdFloat b, SimdFloat t) {
+    return simdMulAdd(t, simdSub(b, a), a);
+}
+
+// Batch De Casteljau evaluator.
+//
+// Control points are kept as separate x and y arrays and the recurrence runs
+// over BEZIER_SIMD_WIDTH parameter values at once, one t per lane. Parameter
+// values that do not fill a whole vector go through the scalar path.
+class SimdBezierEvaluator {
+public:
+    void setControlPoints(const float* points, int count) {
+        pointCount = count;
+        xs.resize(count);
+        ys.resize(count);
+        for (int i = 0; i < count; ++i) {
+            xs[i] = points[i * 2];
+            ys[i] = points[i * 2 + 1];
+        }
+        scratchX.resize(count * BEZIER_SIMD_WIDTH);
+        scratchY.resize(count * BEZIER_SIMD_WIDTH);
+        scalarScratch.resize(2 * count);
+        interleaved.assign(points, points + 2 * count);
+    }
+
+    // Evaluate at numT arbitrary parameter values, writing interleaved x/y to out
+    void evaluate(const float* ts, int numT, float* out) {
+        if (pointCount < 1) return;
+        int i = 0;
+        for (; i + BEZIER_SIMD_WIDTH <= numT; i += BEZIER_SIMD_WIDTH) {
+            evaluateBlock(simdLoad(ts + i), out + i * 2);
+        }
+        evaluateTail(ts + i, numT - i, out + i * 2);
+    }
+
+    // Evaluate resolution + 1 samples at t = i * step (step defaults to 1 / resolution)
+    void evaluateUniform(int resolution, float* out, float step = 0.0f) {
+        if (resolution < 1) return;
+        if (step <= 0.0f) step = 1.0f / resolution;
+        evaluateRange(0, resolution + 1, step, out);
+    }
+
+    // Evaluate samples [begin, end) of the grid t = i * step into out + 2 * begin
+    void evaluateRange(int begin, int end, float step, float* out) {
+        if (pointCount < 1) return;
+
+        float ts[BEZIER_SIMD_WIDTH];
+        int i = begin;
+        for (; i + BEZIER_SIMD_WIDTH <= end; i += BEZIER_SIMD_WIDTH) {
+            for (int lane = 0; lane < BEZIER_SIMD_WIDTH; ++lane) {
+                ts[lane] = (i + lane) * step;
+            }
+            evaluateBlock(simdLoad(ts), out + i * 2);
+        }
+        int tail = end - i;
+        for (int lane = 0; lane < tail; ++lane) {
+            ts[lane] = (i + lane) * step;
+        }
+        evaluateTail(ts, tail, out + i * 2);
+    }
+
+private:
+    int pointCount = 0;
+    std::vector<float> xs, ys;
+    std::vector<float> scratchX, scratchY; // pointCount vectors of BEZIER_SIMD_WIDTH lanes
+    std::vector<float> scalarScratch;
+    std::vector<float> interleaved;
+
+    void evaluateBlock(SimdFloat t, float* out) {
+        int n = pointCount - 1;
+        float* sx = scratchX.data();
+        float* sy = scratchY.data();
+
+        // First level straight from the broadcast control points
+        if (n == 0) {
+            simdStore(sx, simdSet(xs[0]));
+            simdStore(sy, simdSet(ys[0]));
+        }
+        for (int j = 0; j < n; ++j) {
+            simdStore(sx + j * BEZIER_SIMD_WIDTH, simdLerp(simdSet(xs[j]), simdSet(xs[j + 1]), t));
+            simdStore(sy + j * BEZIER_SIMD_WIDTH, simdLerp(simdSet(ys[j]), simdSet(ys[j + 1]), t));
+        }
+        for (int r = 2; r <= n; ++r) {
+            for (int j = 0; j <= n - r; ++j) {
+                float* x0 = sx + j * BEZIER_SIMD_WIDTH;
+                float* y0 = sy + j * BEZIER_SIMD_WIDTH;
+                simdStore(x0, simdLerp(simdLoad(x0), simdLoad(x0 + BEZIER_SIMD_WIDTH), t));
+                simdStore(y0, simdLerp(simdLoad(y0), simdLoad(y0 + BEZIER_SIMD_WIDTH), t));
+            }
+        }
+
+        for (int lane = 0; lane < BEZIER_SIMD_WIDTH; ++lane) {
+            out[lane * 2] = sx[lane];
+            out[lane * 2 + 1] = sy[lane];
+        }
+    }
+
+    void evaluateTail(const float* ts, int numT, float* out) {
+        for (int i = 0; i < numT; ++i) {
+            deCasteljauPoint(interleaved.data(), pointCount, ts[i], scalarScratch.data(),
+                out[i * 2], out[i * 2 + 1]);
+        }
+    }
+};
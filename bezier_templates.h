@@ -0,0 +1,134 @@
+#pragma once
+
+#include <array>
+#include <type_traits>
+
+// Degree-specialized Bezier evaluators.
+//
+// BezierEvaluator<Degree, Dim> evaluates the Bernstein form with compile-time
+// binomial coefficients and std::array storage. Unroll expands every loop
+// over the control points at compile time and hands each step its index as a
+// constant, so quadratic and cubic curves cost a handful of multiply-adds
+// with no loop control or heap access.
+
+constexpr int bezierBinomial(int n, int k) {
+    return (k < 0 || k > n) ? 0 : (k == 0 || k == n) ? 1 : bezierBinomial(n - 1, k - 1) + bezierBinomial(n - 1, k);
+}
+
+template <int K, int End>
+struct Unroll {
+    template <typename F>
+    static void apply(F& f) {
+        f(std::integral_constant<int, K>());
+        Unroll<K + 1, End>::apply(f);
+    }
+};
+
+template <int End>
+struct Unroll<End, End> {
+    template <typename F>
+    static void apply(F&) {}
+};
+
+template <int Degree, int Dim>
+struct BezierEvaluator {
+    static_assert(Degree >= 1, "a Bezier curve needs at least two control points");
+    static_assert(Dim == 2 || Dim == 3, "only 2D and 3D control points are supported");
+
+    typedef std::array<float, Dim> Point;
+    typedef std::array<Point, Degree + 1> ControlPoints;
+
+    static Point evaluate(const ControlPoints& points, float t) {
+        // Powers of t and (1 - t) up to the degree
+        std::array<float, Degree + 1> powT, powS;
+        powT[0] = powS[0] = 1.0f;
+        float s = 1.0f - t;
+        auto powers = [&](auto k) {
+            powT[k + 1] = powT[k] * t;
+            powS[k + 1] = powS[k] * s;
+        };
+        Unroll<0, Degree>::apply(powers);
+
+        Point result{};
+        auto accumulate = [&](auto k) {
+            const float coefficient = (float)bezierBinomial(Degree, decltype(k)::value);
+            float w = coefficient * powT[k] * powS[Degree - k];
+            for (int d = 0; d < Dim; ++d) {
+                result[d] += w * points[k][d];
+            }
+        };
+        Unroll<0, Degree + 1>::apply(accumulate);
+        return result;
+    }
+
+    // Evaluate resolution + 1 samples at t = i / resolution from interleaved points
+    static void evaluateUniform(const float* interleaved, int resolution, float* out) {
+        ControlPoints points;
+        for (int k = 0; k <= Degree; ++k) {
+            for (int d = 0; d < Dim; ++d) {
+                points[k][d] = interleaved[k * Dim + d];
+            }
+        }
+        float step = 1.0f / resolution;
+        for (int i = 0; i <= resolution; ++i) {
+            Point p = evaluate(points, i * step);
+            for (int d = 0; d < Dim; ++d) {
+                out[i * Dim + d] = p[d];
+            }
+        }
+    }
+};
+
+// Highest degree with a dedicated specialization
+const int MAX_SPECIALIZED_DEGREE = 8;
+
+// Generic fallback for any degree and dimension: De Casteljau with caller scratch
+inline void evaluateBezierGeneric(const float* points, int count, int dim, int resolution, float* out, float* scratch) {
+    for (int i = 0; i <= resolution; ++i) {
+        float t = i / (float)resolution;
+        for (int k = 0; k < count * dim; ++k) {
+            scratch[k] = points[k];
+        }
+        for (int r = 1; r < count; ++r) {
+            for (int j = 0; j < count - r; ++j) {
+                for (int d = 0; d < dim; ++d) {
+                    scratch[j * dim + d] += t * (scratch[(j + 1) * dim + d] - scratch[j * dim + d]);
+                }
+            }
+        }
+        for (int d = 0; d < dim; ++d) {
+            out[i * dim + d] = scratch[d];
+        }
+    }
+}
+
+template <int Dim>
+bool evaluateSpecialized(const float* points, int degree, int resolution, float* out) {
+    switch (degree) {
+    case 1: BezierEvaluator<1, Dim>::evaluateUniform(points, resolution, out); return true;
+    case 2: BezierEvaluator<2, Dim>::evaluateUniform(points, resolution, out); return true;
+    case 3: BezierEvaluator<3, Dim>::evaluateUniform(points, resolution, out); return true;
+    case 4: BezierEvaluator<4, Dim>::evaluateUniform(points, resolution, out); return true;
+    case 5: BezierEvaluator<5, Dim>::evaluateUniform(points, resolution, out); return true;
+    case 6: BezierEvaluator<6, Dim>::evaluateUniform(points, resolution, out); return true;
+    case 7: BezierEvaluator<7, Dim>::evaluateUniform(points, resolution, out); return true;
+    case 8: BezierEvaluator<8, Dim>::evaluateUniform(points, resolution, out); return true;
+    default: return false;
+    }
+}
+
+// Runtime dispatch: degrees up to MAX_SPECIALIZED_DEGREE in 2D or 3D use the
+// unrolled templates, everything else the generic engine. scratch must hold
+// count * dim floats for the fallback.
+inline void evaluateBezierDispatch(const float* points, int count, int dim, int resolution, float* out, float* scratch) {
+    if (count < 2 || resolution < 1) return;
+    int degree = count - 1;
+    bool handled = false;
+    if (degree <= MAX_SPECIALIZED_DEGREE) {
+        if (dim == 2) handled = evaluateSpecialized<2>(points, degree, resolution, out);
+        else if (dim == 3) handled = evaluateSpecialized<3>(points, degree, resolution, out);
+    }
+    if (!handled) {
+        evaluateBezierGeneric(points, count, dim, resolution, out, scratch);
+    }
+}
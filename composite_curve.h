@@ -0,0 +1,286 @@
+#pragma once
+
+#include <vector>
+#include "bezier_bounds.h"
+
+// How the control points are turned into a curve
+enum class CurveBasis {
+    GlobalBezier,    // one Bezier of degree count - 1
+    UniformBSpline,  // cubic B-spline chain, clamped at both ends
+    CatmullRom,      // cubic Catmull-Rom chain through every point
+    PiecewiseBezier, // cubic Beziers sharing end points, 3 points per segment plus one
+    Count
+};
+
+inline const char* curveBasisName(CurveBasis basis) {
+    switch (basis) {
+    case CurveBasis::GlobalBezier: return "Global Bezier";
+    case CurveBasis::UniformBSpline: return "Uniform cubic B-spline";
+    case CurveBasis::CatmullRom: return "Catmull-Rom spline";
+    case CurveBasis::PiecewiseBezier: return "Piecewise cubic Bezier";
+    default: return "Unknown";
+    }
+}
+
+// Blending weights of the four points of a cubic segment at t
+inline void cubicSegmentWeights(CurveBasis basis, float t, float* w) {
+    float t2 = t * t, t3 = t2 * t;
+    switch (basis) {
+    case CurveBasis::UniformBSpline: {
+        float s = 1.0f - t;
+        w[0] = s * s * s / 6.0f;
+        w[1] = (3.0f * t3 - 6.0f * t2 + 4.0f) / 6.0f;
+        w[2] = (-3.0f * t3 + 3.0f * t2 + 3.0f * t + 1.0f) / 6.0f;
+        w[3] = t3 / 6.0f;
+        break;
+    }
+    case CurveBasis::PiecewiseBezier: {
+        float s = 1.0f - t;
+        w[0] = s * s * s;
+        w[1] = 3.0f * t * s * s;
+        w[2] = 3.0f * t2 * s;
+        w[3] = t3;
+        break;
+    }
+    case CurveBasis::CatmullRom:
+    default:
+        w[0] = 0.5f * (-t3 + 2.0f * t2 - t);
+        w[1] = 0.5f * (3.0f * t3 - 5.0f * t2 + 2.0f);
+        w[2] = 0.5f * (-3.0f * t3 + 4.0f * t2 + t);
+        w[3] = 0.5f * (t3 - t2);
+        break;
+    }
+}
+
+// First control point index used by segment s
+inline int compositeFirstPoint(CurveBasis basis, int s) {
+    switch (basis) {
+    case CurveBasis::UniformBSpline: return s - 2;
+    case CurveBasis::PiecewiseBezier: return 3 * s;
+    default: return s - 1;
+    }
+}
+
+// Segments a curve through count points has in basis
+inline int compositeSegmentCount(CurveBasis basis, int count) {
+    // The clamped B-spline gets two extra segments from the repeated end points;
+    // piecewise Beziers leave out trailing points that do not complete a segment
+    if (count < 2) return 0;
+    switch (basis) {
+    case CurveBasis::UniformBSpline: return count + 1;
+    case CurveBasis::PiecewiseBezier: return (count - 1) / 3;
+    default: return count - 1;
+    }
+}
+
+// Range of segments whose four points include point index, possibly empty
+inline void compositeSegmentsUsing(CurveBasis basis, int index, int& first, int& last) {
+    if (basis == CurveBasis::PiecewiseBezier) {
+        // Segment end points are shared by two segments, inner points owned by one
+        first = index % 3 == 0 ? index / 3 - 1 : index / 3;
+        last = index / 3;
+        return;
+    }
+    last = index - compositeFirstPoint(basis, 0);
+    first = last - 3;
+}
+
+// Points an append at the end adds: a whole segment (two handles and the end
+// point) to a piecewise Bezier whose segments are complete, else one point
+inline int compositeAppendCount(CurveBasis basis, int count) {
+    return basis == CurveBasis::PiecewiseBezier && count >= 1 && (count - 1) % 3 == 0 ? 3 : 1;
+}
+
+// Points deleting point index removes, starting at first; 0 if it may not be
+// removed. A complete piecewise Bezier loses the end point index is or
+// belongs to along with its two handles, so the segments stay intact and the
+// neighbours of an inner end point merge; it keeps at least one segment.
+inline int compositeEraseRange(CurveBasis basis, int count, int index, int& first) {
+    if (basis != CurveBasis::PiecewiseBezier || (count - 1) % 3 != 0) {
+        first = index;
+        return 1;
+    }
+    if (count < 7) return 0;
+    int end = index % 3 == 2 ? index + 1 : index - index % 3;
+    first = end == 0 ? 0 : (end == count - 1 ? count - 3 : end - 1);
+    return 3;
+}
+
+// Evaluate segment s of the curve through count points at t in [0, 1].
+// Stateless, so it is safe while a CompositeCurve is rebuilt elsewhere.
+inline void evaluateCompositeSegment(CurveBasis basis, const float* points, int count, int s, float t,
+    float& x, float& y) {
+    float w[4];
+    cubicSegmentWeights(basis, t, w);
+    x = y = 0.0f;
+    for (int k = 0; k < 4; ++k) {
+        int i = compositeFirstPoint(basis, s) + k;
+        const float* p = points + 2 * (i < 0 ? 0 : (i >= count ? count - 1 : i));
+        x += w[k] * p[0];
+        y += w[k] * p[1];
+    }
+}
+
+// Cubic Bezier control points (8 floats) of segment s of the curve through
+// count points, converted from the samples at t = 0, 1/3, 2/3, 1
+inline void compositeSegmentBezier(CurveBasis basis, const float* points, int count, int s, float* out) {
+    float samples[8];
+    for (int k = 0; k < 4; ++k) {
+        evaluateCompositeSegment(basis, points, count, s, k / 3.0f, samples[k * 2], samples[k * 2 + 1]);
+    }
+    for (int c = 0; c < 2; ++c) {
+        float s0 = samples[c], s1 = samples[2 + c], s2 = samples[4 + c], s3 = samples[6 + c];
+        out[c] = s0;
+        out[2 + c] = (-5.0f * s0 + 18.0f * s1 - 9.0f * s2 + 2.0f * s3) / 6.0f;
+        out[4 + c] = (2.0f * s0 - 9.0f * s1 + 18.0f * s2 - 5.0f * s3) / 6.0f;
+        out[6 + c] = s3;
+    }
+}
+
+// Piecewise cubic curve with local support.
+//
+// Segment s blends the four points starting at firstPoint(s); indices past
+// either end repeat the end point, which clamps the B-spline to its end
+// points and lets Catmull-Rom reach the first and last point. Piecewise
+// Beziers step three points per segment and share the end points. Each
+// segment owns resolution vertices of the polyline, plus one closing vertex
+// at the end, so moving a point only rewrites the at most four segments that
+// reference it. With a cull rectangle set, segments whose exact bounds miss
+// it get a straight line instead of their samples.
+class CompositeCurve {
+public:
+    explicit CompositeCurve(int segmentResolution = 32) : resolution(segmentResolution) {}
+
+    void setBasis(CurveBasis newBasis) {
+        if (basis == newBasis) return;
+        basis = newBasis;
+        weights.clear();
+    }
+
+    // Takes effect at the next rebuild
+    void setSegmentResolution(int newResolution) {
+        if (resolution == newResolution) return;
+        resolution = newResolution;
+        weights.clear();
+    }
+
+    void setCullRect(float minX, float minY, float maxX, float maxY) {
+        culling = true;
+        cullRect[0] = minX;
+        cullRect[1] = minY;
+        cullRect[2] = maxX;
+        cullRect[3] = maxY;
+    }
+
+    void disableCulling() { culling = false; }
+
+    CurveBasis currentBasis() const { return basis; }
+    int segmentResolution() const { return resolution; }
+    int segmentCount() const { return segments; }
+
+    // Interleaved x/y polyline, segmentCount() * segmentResolution() + 1 vertices
+    const std::vector<float>& vertices() const { return polyline; }
+
+    // First control point index used by segment s
+    int firstPoint(int s) const { return compositeFirstPoint(basis, s); }
+
+    // Segments a curve through count points has in the current basis
+    int segmentCountFor(int count) const { return compositeSegmentCount(basis, count); }
+
+    // Retessellate every segment
+    void rebuild(const float* points, int count) {
+        buildWeights();
+        pointCount = count;
+        segments = segmentCountFor(count);
+        polyline.resize(segments > 0 ? 2 * (segments * resolution + 1) : 0);
+        for (int s = 0; s < segments; ++s) {
+            tessellateSegment(points, s);
+        }
+    }
+
+    // Point index moved; retessellate only the segments that reference it.
+    // [firstVertex, lastVertex] receives the range of rewritten vertices.
+    bool updatePoint(const float* points, int index, int& firstVertex, int& lastVertex) {
+        if (segments == 0) return false;
+        int first, last;
+        compositeSegmentsUsing(basis, index, first, last);
+        if (first < 0) first = 0;
+        if (last > segments - 1) last = segments - 1;
+        if (first > last) return false;
+
+        for (int s = first; s <= last; ++s) {
+            tessellateSegment(points, s);
+        }
+        firstVertex = first * resolution;
+        lastVertex = last == segments - 1 ? segments * resolution : (last + 1) * resolution - 1;
+        return true;
+    }
+
+    // Evaluate segment s of the current basis at t in [0, 1]
+    void evaluateSegment(const float* points, int s, float t, float& x, float& y) const {
+        evaluateCompositeSegment(basis, points, pointCount, s, t, x, y);
+    }
+
+    // Cubic Bezier control points (8 floats) of segment s of a curve through count points
+    void segmentBezier(const float* points, int count, int s, float* out) const {
+        compositeSegmentBezier(basis, points, count, s, out);
+    }
+
+private:
+    CurveBasis basis = CurveBasis::CatmullRom;
+    int resolution;
+    int pointCount = 0;
+    int segments = 0;
+    std::vector<float> weights; // (resolution + 1) x 4 blending weights
+    std::vector<float> polyline;
+    bool culling = false;
+    float cullRect[4] = {}; // minX, minY, maxX, maxY
+
+    void buildWeights() {
+        if (!weights.empty()) return;
+        weights.resize(4 * (resolution + 1));
+        for (int k = 0; k <= resolution; ++k) {
+            cubicSegmentWeights(basis, k / (float)resolution, &weights[k * 4]);
+        }
+    }
+
+    int clampIndex(int i) const {
+        return i < 0 ? 0 : (i >= pointCount ? pointCount - 1 : i);
+    }
+
+    bool segmentVisible(const float* points, int s) const {
+        if (!culling) return true;
+        float bezier[8];
+        segmentBezier(points, pointCount, s, bezier);
+        return bezierBounds(bezier, 4).overlaps(cullRect[0], cullRect[1], cullRect[2], cullRect[3]);
+    }
+
+    void tessellateSegment(const float* points, int s) {
+        const float* p[4];
+        for (int k = 0; k < 4; ++k) {
+            p[k] = points + 2 * clampIndex(firstPoint(s) + k);
+        }
+
+        // The last segment also writes the closing vertex
+        int samples = s == segments - 1 ? resolution + 1 : resolution;
+        float* out = &polyline[2 * s * resolution];
+        if (!segmentVisible(points, s)) {
+            // Off screen: only the end points matter, keep the vertex count
+            const float* a = &weights[0];
+            const float* b = &weights[resolution * 4];
+            for (int c = 0; c < 2; ++c) {
+                float start = a[0] * p[0][c] + a[1] * p[1][c] + a[2] * p[2][c] + a[3] * p[3][c];
+                float end = b[0] * p[0][c] + b[1] * p[1][c] + b[2] * p[2][c] + b[3] * p[3][c];
+                for (int k = 0; k < samples; ++k) {
+                    out[k * 2 + c] = start + (end - start) * (k / (float)resolution);
+                }
+            }
+            return;
+        }
+        for (int k = 0; k < samples; ++k) {
+            const float* w = &weights[k * 4];
+            out[k * 2] = w[0] * p[0][0] + w[1] * p[1][0] + w[2] * p[2][0] + w[3] * p[3][0];
+            out[k * 2 + 1] = w[0] * p[0][1] + w[1] * p[1][1] + w[2] * p[2][1] + w[3] * p[3][1];
+        }
+    }
+};
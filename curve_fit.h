@@ -0,0 +1,229 @@
+#pragma once
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+// Fits a polyline (e.g. a raw cursor stream) with a chain of cubic Beziers.
+//
+// Schneider's algorithm ("An Algorithm for Automatically Fitting Digitized
+// Curves", Graphics Gems 1990): the samples get chord-length parameters,
+// the two inner control points come from a least-squares fit along fixed end
+// tangents, and if the worst sample is off by more than maxError the fit is
+// retried with Newton-reparameterized samples, then split at that sample.
+// Both sides of a split share the tangent there, so the chain is G1
+// continuous. Pieces are worked off an explicit stack, left first, so the
+// segments come out in order.
+//
+// The result uses the CurveBasis::PiecewiseBezier layout: the first point,
+// then three points (two handles and the end point) per segment.
+class BezierFitter {
+public:
+    static const int MAX_ITERATIONS = 4; // reparameterizations before splitting
+
+    // Fit count interleaved x/y points within maxError; out receives 3k + 1 points
+    void fit(const float* points, int count, float maxError, std::vector<float>& out) {
+        out.clear();
+        segments = 0;
+
+        // Repeated samples (the cursor standing still) carry no direction
+        samples.clear();
+        for (int i = 0; i < count; ++i) {
+            Vec p = { points[i * 2], points[i * 2 + 1] };
+            if (samples.empty() || lengthSq(sub(p, samples.back())) > 1e-12f) samples.push_back(p);
+        }
+        int last = (int)samples.size() - 1;
+        if (last < 0) return;
+        out.push_back(samples[0].x);
+        out.push_back(samples[0].y);
+        if (last == 0) return;
+
+        u.resize(samples.size());
+        uPrime.resize(samples.size());
+        float errorSq = maxError * maxError;
+        stack.clear();
+        stack.push_back({ 0, last, leftTangent(0), rightTangent(last) });
+        while (!stack.empty()) {
+            Piece piece = stack.back();
+            stack.pop_back();
+            int split = fitPiece(piece, errorSq, out);
+            if (split < 0) continue;
+
+            // Right half first, so the left one is fitted (and emitted) next
+            Vec center = centerTangent(split);
+            stack.push_back({ split, piece.last, scale(center, -1.0f), piece.tangentB });
+            stack.push_back({ piece.first, split, piece.tangentA, center });
+        }
+    }
+
+    int lastSegments() const { return segments; }
+
+private:
+    struct Vec {
+        float x, y;
+    };
+
+    struct Piece {
+        int first, last;
+        Vec tangentA; // leaving the first sample
+        Vec tangentB; // leaving the last sample backwards
+    };
+
+    std::vector<Vec> samples;
+    std::vector<float> u, uPrime;
+    std::vector<Piece> stack;
+    int segments = 0;
+
+    static Vec add(Vec a, Vec b) { return { a.x + b.x, a.y + b.y }; }
+    static Vec sub(Vec a, Vec b) { return { a.x - b.x, a.y - b.y }; }
+    static Vec scale(Vec a, float s) { return { a.x * s, a.y * s }; }
+    static float dot(Vec a, Vec b) { return a.x * b.x + a.y * b.y; }
+    static float lengthSq(Vec a) { return dot(a, a); }
+
+    static Vec normalize(Vec a) {
+        float length = std::sqrt(lengthSq(a));
+        return length > 0.0f ? scale(a, 1.0f / length) : a;
+    }
+
+    Vec leftTangent(int first) const { return normalize(sub(samples[first + 1], samples[first])); }
+    Vec rightTangent(int last) const { return normalize(sub(samples[last - 1], samples[last])); }
+
+    Vec centerTangent(int center) const {
+        Vec tangent = sub(samples[center - 1], samples[center + 1]);
+        // A sharp reversal cancels out; fall back to the incoming direction
+        if (lengthSq(tangent) == 0.0f) tangent = sub(samples[center - 1], samples[center]);
+        return normalize(tangent);
+    }
+
+    static Vec bezierPoint(const Vec* b, float t) {
+        float s = 1.0f - t;
+        return add(add(scale(b[0], s * s * s), scale(b[1], 3.0f * s * s * t)),
+            add(scale(b[2], 3.0f * s * t * t), scale(b[3], t * t * t)));
+    }
+
+    static Vec bezierTangent(const Vec* b, float t) {
+        float s = 1.0f - t;
+        return add(add(scale(sub(b[1], b[0]), 3.0f * s * s), scale(sub(b[2], b[1]), 6.0f * s * t)),
+            scale(sub(b[3], b[2]), 3.0f * t * t));
+    }
+
+    static Vec bezierSecond(const Vec* b, float t) {
+        Vec a = add(sub(b[2], scale(b[1], 2.0f)), b[0]);
+        Vec c = add(sub(b[3], scale(b[2], 2.0f)), b[1]);
+        return add(scale(a, 6.0f * (1.0f - t)), scale(c, 6.0f * t));
+    }
+
+    void emit(const Vec* b, std::vector<float>& out) {
+        for (int k = 1; k < 4; ++k) {
+            out.push_back(b[k].x);
+            out.push_back(b[k].y);
+        }
+        ++segments;
+    }
+
+    // Emits the piece's segment and returns -1, or returns the sample to split at
+    int fitPiece(const Piece& piece, float errorSq, std::vector<float>& out) {
+        int first = piece.first, last = piece.last;
+        Vec bezier[4];
+        if (last - first == 1) {
+            // Two samples: handles a third of the way along the end tangents
+            float third = std::sqrt(lengthSq(sub(samples[last], samples[first]))) / 3.0f;
+            bezier[0] = samples[first];
+            bezier[1] = add(samples[first], scale(piece.tangentA, third));
+            bezier[2] = add(samples[last], scale(piece.tangentB, third));
+            bezier[3] = samples[last];
+            emit(bezier, out);
+            return -1;
+        }
+
+        chordLengthParameters(first, last);
+        generate(first, last, piece.tangentA, piece.tangentB, bezier);
+        int split;
+        float error = maxError(first, last, bezier, split);
+        if (error <= errorSq) {
+            emit(bezier, out);
+            return -1;
+        }
+        // Close enough that better parameters may be all it takes
+        if (error <= 4.0f * errorSq) {
+            for (int i = 0; i < MAX_ITERATIONS; ++i) {
+                reparameterize(first, last, bezier);
+                generate(first, last, piece.tangentA, piece.tangentB, bezier);
+                error = maxError(first, last, bezier, split);
+                if (error <= errorSq) {
+                    emit(bezier, out);
+                    return -1;
+                }
+            }
+        }
+        return split;
+    }
+
+    void chordLengthParameters(int first, int last) {
+        u[first] = 0.0f;
+        for (int i = first + 1; i <= last; ++i) {
+            u[i] = u[i - 1] + std::sqrt(lengthSq(sub(samples[i], samples[i - 1])));
+        }
+        for (int i = first + 1; i <= last; ++i) {
+            u[i] /= u[last];
+        }
+    }
+
+    // Least-squares handle lengths along the end tangents for parameters u
+    void generate(int first, int last, Vec tangentA, Vec tangentB, Vec* bezier) const {
+        Vec p0 = samples[first], p3 = samples[last];
+        float c00 = 0.0f, c01 = 0.0f, c11 = 0.0f, x0 = 0.0f, x1 = 0.0f;
+        for (int i = first; i <= last; ++i) {
+            float t = u[i], s = 1.0f - t;
+            float b0 = s * s * s, b1 = 3.0f * s * s * t, b2 = 3.0f * s * t * t, b3 = t * t * t;
+            Vec a0 = scale(tangentA, b1), a1 = scale(tangentB, b2);
+            c00 += dot(a0, a0);
+            c01 += dot(a0, a1);
+            c11 += dot(a1, a1);
+            Vec rest = sub(samples[i], add(scale(p0, b0 + b1), scale(p3, b2 + b3)));
+            x0 += dot(a0, rest);
+            x1 += dot(a1, rest);
+        }
+        float determinant = c00 * c11 - c01 * c01;
+        float alphaA = determinant != 0.0f ? (x0 * c11 - x1 * c01) / determinant : 0.0f;
+        float alphaB = determinant != 0.0f ? (c00 * x1 - c01 * x0) / determinant : 0.0f;
+
+        // Degenerate or backwards handles fall back to a third of the chord
+        float chord = std::sqrt(lengthSq(sub(p3, p0)));
+        float epsilon = 1e-6f * chord;
+        if (alphaA < epsilon || alphaB < epsilon) {
+            alphaA = alphaB = chord / 3.0f;
+        }
+        bezier[0] = p0;
+        bezier[1] = add(p0, scale(tangentA, alphaA));
+        bezier[2] = add(p3, scale(tangentB, alphaB));
+        bezier[3] = p3;
+    }
+
+    // Largest squared distance of a sample to its point on the curve
+    float maxError(int first, int last, const Vec* bezier, int& split) const {
+        float worst = 0.0f;
+        split = (first + last + 1) / 2;
+        for (int i = first + 1; i < last; ++i) {
+            float distance = lengthSq(sub(bezierPoint(bezier, u[i]), samples[i]));
+            if (distance >= worst) {
+                worst = distance;
+                split = i;
+            }
+        }
+        return worst;
+    }
+
+    // One Newton step per sample towards the closest point of the curve
+    void reparameterize(int first, int last, const Vec* bezier) {
+        for (int i = first; i <= last; ++i) {
+            float t = u[i];
+            Vec error = sub(bezierPoint(bezier, t), samples[i]);
+            Vec d1 = bezierTangent(bezier, t);
+            float numerator = dot(error, d1);
+            float denominator = lengthSq(d1) + dot(error, bezierSecond(bezier, t));
+            uPrime[i] = denominator != 0.0f ? std::min(1.0f, std::max(0.0f, t - numerator / denominator)) : t;
+        }
+        std::copy(uPrime.begin() + first, uPrime.begin() + last + 1, u.begin() + first);
+    }
+};
@@ -0,0 +1,160 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <vector>
+#include "shader_utils.h"
+#include "view_transform.h"
+#include "bezier_quadratic.h"
+
+// Floats per fill vertex: position, then Loop-Blinn coordinates (u, v)
+const int FILL_VERTEX_FLOATS = 4;
+
+// Triangles of the closed shape bounded by a chain of quadratic pieces and
+// the chord from its end back to its start.
+//
+// Every piece contributes a fan triangle from the first point, which covers
+// the control polygon, and its control triangle with the Loop-Blinn
+// coordinates (0, 0), (1/2, 0), (1, 1); inside the curve u^2 - v < 0. Fan
+// triangles get (0, 1) everywhere, so they are always inside. The list only
+// depends on the control points, never on the zoom level.
+inline void buildFillTriangles(const std::vector<float>& quadratics, std::vector<float>& out) {
+    out.clear();
+    int count = (int)quadratics.size() / QUADRATIC_FLOATS;
+    if (count < 1) return;
+
+    const float* anchor = &quadratics[0];
+    auto vertex = [&](const float* p, float u, float v) {
+        out.push_back(p[0]);
+        out.push_back(p[1]);
+        out.push_back(u);
+        out.push_back(v);
+    };
+    for (int i = 0; i < count; ++i) {
+        const float* piece = &quadratics[i * QUADRATIC_FLOATS];
+        vertex(anchor, 0.0f, 1.0f);
+        vertex(piece, 0.0f, 1.0f);
+        vertex(piece + 4, 0.0f, 1.0f);
+
+        vertex(piece, 0.0f, 0.0f);
+        vertex(piece + 2, 0.5f, 0.0f);
+        vertex(piece + 4, 1.0f, 1.0f);
+    }
+}
+
+// Stencil-then-cover renderer for filled curved shapes.
+//
+// The stencil pass draws the triangles from buildFillTriangles with color
+// writes off, inverting the low stencil bit for every fragment inside the
+// curve, so each pixel ends up odd exactly when it is inside the shape
+// (even-odd rule). The cover pass then draws one screen-sized quad, colors
+// the odd pixels and clears the bit again. Curve edges are resolved per
+// pixel, so the fill stays sharp at any zoom without retessellating.
+// Needs a framebuffer with a stencil buffer.
+class FillRenderer {
+public:
+    void init() {
+        stencilProgram = createProgram(stencilVertexSource, stencilFragmentSource);
+        coverProgram = createProgram(coverVertexSource, coverFragmentSource);
+
+        glGenVertexArrays(1, &vao);
+        glBindVertexArray(vao);
+        glEnableVertexAttribArray(0);
+        glEnableVertexAttribArray(1);
+        glBindVertexArray(0);
+        glGenVertexArrays(1, &coverVAO);
+    }
+
+    void destroy() {
+        glDeleteVertexArrays(1, &vao);
+        glDeleteVertexArrays(1, &coverVAO);
+        glDeleteProgram(stencilProgram);
+        glDeleteProgram(coverProgram);
+    }
+
+    // World-to-screen mapping applied to every point; identity by default
+    void setView(const ViewTransform& transform) {
+        view = transform;
+    }
+
+    // Fill the shape whose vertexCount fill vertices are stored at offset in buffer
+    void draw(GLuint buffer, GLintptr offset, int vertexCount, float r, float g, float b, float a) {
+        if (vertexCount < 3) return;
+
+        // Stencil: flip bit 0 for every covered fragment
+        glEnable(GL_STENCIL_TEST);
+        glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+        glStencilMask(0x01);
+        glStencilFunc(GL_ALWAYS, 0, 0x01);
+        glStencilOp(GL_KEEP, GL_KEEP, GL_INVERT);
+
+        glUseProgram(stencilProgram);
+        setViewUniform(stencilProgram, view);
+        glBindVertexArray(vao);
+        glBindBuffer(GL_ARRAY_BUFFER, buffer);
+        GLsizei stride = FILL_VERTEX_FLOATS * sizeof(float);
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, stride, (const void*)offset);
+        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, stride, (const void*)(offset + 2 * sizeof(float)));
+        glDrawArrays(GL_TRIANGLES, 0, vertexCount);
+
+        // Cover: color odd pixels and reset the bit everywhere
+        glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+        glStencilFunc(GL_NOTEQUAL, 0, 0x01);
+        glStencilOp(GL_ZERO, GL_ZERO, GL_ZERO);
+
+        glUseProgram(coverProgram);
+        glUniform4f(glGetUniformLocation(coverProgram, "uColor"), r, g, b, a);
+        glBindVertexArray(coverVAO);
+        glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+
+        glBindVertexArray(0);
+        glStencilMask(0xFF);
+        glDisable(GL_STENCIL_TEST);
+    }
+
+private:
+    GLuint stencilProgram = 0;
+    GLuint coverProgram = 0;
+    GLuint vao = 0;
+    GLuint coverVAO = 0; // attribute-less
+    ViewTransform view;
+
+    const char* stencilVertexSource = R"(
+#version 330 core
+layout (location = 0) in vec2 position;
+layout (location = 1) in vec2 curveCoord;
+uniform vec4 uView;
+out vec2 uv;
+void main() {
+    uv = curveCoord;
+    gl_Position = vec4(position * uView.xy + uView.zw, 0.0, 1.0);
+}
+)";
+
+    // Loop-Blinn test for quadratics: outside the curve where u^2 - v > 0
+    const char* stencilFragmentSource = R"(
+#version 330 core
+in vec2 uv;
+out vec4 FragColor;
+void main() {
+    if (uv.x * uv.x - uv.y > 0.0) discard;
+    FragColor = vec4(0.0);
+}
+)";
+
+    const char* coverVertexSource = R"(
+#version 330 core
+void main() {
+    vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+    gl_Position = vec4(corner * 2.0 - 1.0, 0.0, 1.0);
+}
+)";
+
+    const char* coverFragmentSource = R"(
+#version 330 core
+uniform vec4 uColor;
+out vec4 FragColor;
+void main() {
+    FragColor = uColor;
+}
+)";
+};
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include "bezier_simd.h"
+
+// Fixed pool of worker threads for data-parallel loops.
+//
+// parallelFor splits [0, count) into one contiguous slice per thread, the
+// calling thread included, and blocks until every slice is done. Threads are
+// created once and sleep on a condition variable between jobs.
+class WorkerPool {
+public:
+    explicit WorkerPool(unsigned threads = std::thread::hardware_concurrency()) {
+        if (threads < 1) threads = 1;
+        for (unsigned i = 1; i < threads; ++i) {
+            workers.emplace_back(&WorkerPool::run, this, i);
+        }
+    }
+
+    ~WorkerPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+    }
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    unsigned threadCount() const { return (unsigned)workers.size() + 1; }
+
+    // fn(begin, end, slice) is called once per slice; slice is in [0, threadCount())
+    void parallelFor(int count, const std::function<void(int, int, int)>& fn) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            job = &fn;
+            jobCount = count;
+            pending = (int)workers.size();
+            ++generation;
+        }
+        wake.notify_all();
+
+        runSlice(0, count, fn);
+
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [this] { return pending == 0; });
+        job = nullptr;
+    }
+
+private:
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+    const std::function<void(int, int, int)>* job = nullptr;
+    int jobCount = 0;
+    int pending = 0;
+    unsigned generation = 0;
+    bool stopping = false;
+
+    void runSlice(int slice, int count, const std::function<void(int, int, int)>& fn) {
+        int threads = (int)threadCount();
+        int begin = (int)((long long)count * slice / threads);
+        int end = (int)((long long)count * (slice + 1) / threads);
+        if (begin < end) fn(begin, end, slice);
+    }
+
+    void run(unsigned slice) {
+        unsigned seen = 0;
+        for (;;) {
+            const std::function<void(int, int, int)>* current;
+            int count;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [&] { return stopping || generation != seen; });
+                if (stopping) return;
+                seen = generation;
+                current = job;
+                count = jobCount;
+            }
+
+            runSlice((int)slice, count, *current);
+
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--pending == 0) done.notify_one();
+        }
+    }
+};
+
+// Multi-threaded uniform-grid tessellation.
+//
+// Each thread evaluates its own slice of the t range with its own SIMD
+// evaluator and writes straight into its part of the preallocated output.
+// Curves whose work (samples * degree^2) is below MIN_PARALLEL_WORK stay on
+// the calling thread, where waking the pool would cost more than it saves.
+class ParallelTessellator {
+public:
+    static const long long MIN_PARALLEL_WORK = 1 << 18;
+
+    ParallelTessellator() : evaluators(pool.threadCount()) {}
+
+    // Writes resolution + 1 points at t = i * step into out
+    void tessellate(const float* points, int count, int resolution, float step, float* out) {
+        if (count < 1 || resolution < 1) return;
+        int samples = resolution + 1;
+        long long work = (long long)samples * count * count;
+
+        if (work < MIN_PARALLEL_WORK || pool.threadCount() == 1) {
+            threadsUsed = 1;
+            evaluators[0].setControlPoints(points, count);
+            evaluators[0].evaluateRange(0, samples, step, out);
+            return;
+        }
+
+        threadsUsed = pool.threadCount();
+        pool.parallelFor(samples, [&](int begin, int end, int slice) {
+            evaluators[slice].setControlPoints(points, count);
+            evaluators[slice].evaluateRange(begin, end, step, out);
+        });
+    }
+
+    unsigned lastThreadCount() const { return threadsUsed; }
+
+private:
+    WorkerPool pool;
+    std::vector<SimdBezierEvaluator> evaluators; // one per slice, so scratch is never shared
+    unsigned threadsUsed = 1;
+};
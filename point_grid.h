@@ -0,0 +1,192 @@
+#pragma once
+
+#include <vector>
+#include <unordered_map>
+#include <cmath>
+#include <algorithm>
+#include <cstdint>
+
+// Dynamic uniform-grid index over a list of 2D points.
+//
+// Points are identified by their index in the caller's list and the index
+// follows the list: insert and erase renumber the points after them, so the
+// grid can shadow a std::vector of points that is edited in place. Cells are
+// hashed, so the grid is unbounded and empty space costs nothing. With the
+// cell size close to the query radius, nearest and radius queries only look
+// at a handful of cells, whatever the number of points. Moving a point that
+// stays in its cell is two stores.
+class PointGrid {
+public:
+    explicit PointGrid(float size = 0.05f) : cellSize(size) {}
+
+    int size() const { return (int)points.size(); }
+    float currentCellSize() const { return cellSize; }
+
+    // Rebucket everything, e.g. when the typical query radius changed a lot
+    void setCellSize(float size) {
+        if (size <= 0.0f || size == cellSize) return;
+        cellSize = size;
+        rehash();
+    }
+
+    void clear() {
+        points.clear();
+        cells.clear();
+    }
+
+    // Replace the contents with count interleaved x/y points
+    void build(const float* xy, int count) {
+        points.resize(count);
+        for (int i = 0; i < count; ++i) {
+            points[i].x = xy[i * 2];
+            points[i].y = xy[i * 2 + 1];
+        }
+        rehash();
+    }
+
+    // Insert a point at index; points from index on move up by one
+    void insert(int index, float x, float y) {
+        for (int i = (int)points.size() - 1; i >= index; --i) {
+            renumber(i, i + 1);
+        }
+        Entry entry;
+        entry.x = x;
+        entry.y = y;
+        points.insert(points.begin() + index, entry);
+        link(index);
+    }
+
+    // Remove the point at index; points after it move down by one
+    void erase(int index) {
+        unlink(index);
+        for (int i = index + 1; i < (int)points.size(); ++i) {
+            renumber(i, i - 1);
+        }
+        points.erase(points.begin() + index);
+    }
+
+    void move(int index, float x, float y) {
+        Entry& entry = points[index];
+        if (keyFor(x, y) == entry.key) {
+            entry.x = x;
+            entry.y = y;
+            return;
+        }
+        unlink(index);
+        entry.x = x;
+        entry.y = y;
+        link(index);
+    }
+
+    // Nearest point within maxDistance of (x, y), other than exclude; -1 if none
+    int nearest(float x, float y, float maxDistance, int exclude = -1) const {
+        int best = -1;
+        float bestSq = maxDistance * maxDistance;
+        int cx = cellCoord(x), cy = cellCoord(y);
+        int rings = (int)std::ceil(maxDistance / cellSize);
+        for (int ring = 0; ring <= rings; ++ring) {
+            // Anything in this ring or beyond is at least (ring - 1) cells away
+            float reach = (ring - 1) * cellSize;
+            if (best >= 0 && reach > 0.0f && reach * reach > bestSq) break;
+            for (int dy = -ring; dy <= ring; ++dy) {
+                // Interior rows only need the two cells on the ring's edge
+                int step = (dy == -ring || dy == ring) ? 1 : 2 * ring;
+                for (int dx = -ring; dx <= ring; dx += step) {
+                    const std::vector<int>* cell = find(cx + dx, cy + dy);
+                    if (!cell) continue;
+                    for (int i : *cell) {
+                        if (i == exclude) continue;
+                        float d = distanceSq(i, x, y);
+                        if (d <= bestSq) {
+                            bestSq = d;
+                            best = i;
+                        }
+                    }
+                }
+            }
+        }
+        return best;
+    }
+
+    // Indices of all points within radius of (x, y), unordered
+    void queryRadius(float x, float y, float radius, std::vector<int>& out) const {
+        out.clear();
+        int x0 = cellCoord(x - radius), x1 = cellCoord(x + radius);
+        int y0 = cellCoord(y - radius), y1 = cellCoord(y + radius);
+        for (int cy = y0; cy <= y1; ++cy) {
+            for (int cx = x0; cx <= x1; ++cx) {
+                const std::vector<int>* cell = find(cx, cy);
+                if (!cell) continue;
+                for (int i : *cell) {
+                    if (distanceSq(i, x, y) <= radius * radius) out.push_back(i);
+                }
+            }
+        }
+    }
+
+private:
+    struct Entry {
+        float x = 0.0f, y = 0.0f;
+        uint64_t key = 0;
+        int slot = 0; // position in its cell's list
+    };
+
+    float cellSize;
+    std::vector<Entry> points;
+    std::unordered_map<uint64_t, std::vector<int>> cells;
+
+    int cellCoord(float v) const {
+        return (int)std::floor(v / cellSize);
+    }
+
+    static uint64_t packKey(int cx, int cy) {
+        return ((uint64_t)(uint32_t)cx << 32) | (uint32_t)cy;
+    }
+
+    uint64_t keyFor(float x, float y) const {
+        return packKey(cellCoord(x), cellCoord(y));
+    }
+
+    const std::vector<int>* find(int cx, int cy) const {
+        auto it = cells.find(packKey(cx, cy));
+        return it == cells.end() ? nullptr : &it->second;
+    }
+
+    float distanceSq(int i, float x, float y) const {
+        float dx = points[i].x - x;
+        float dy = points[i].y - y;
+        return dx * dx + dy * dy;
+    }
+
+    void link(int index) {
+        Entry& entry = points[index];
+        entry.key = keyFor(entry.x, entry.y);
+        std::vector<int>& cell = cells[entry.key];
+        entry.slot = (int)cell.size();
+        cell.push_back(index);
+    }
+
+    // Swap-remove from the cell, fixing the slot of the point moved into the gap
+    void unlink(int index) {
+        Entry& entry = points[index];
+        auto it = cells.find(entry.key);
+        std::vector<int>& cell = it->second;
+        int last = cell.back();
+        cell[entry.slot] = last;
+        points[last].slot = entry.slot;
+        cell.pop_back();
+        if (cell.empty()) cells.erase(it);
+    }
+
+    void renumber(int from, int to) {
+        const Entry& entry = points[from];
+        cells[entry.key][entry.slot] = to;
+    }
+
+    void rehash() {
+        cells.clear();
+        for (int i = 0; i < (int)points.size(); ++i) {
+            link(i);
+        }
+    }
+};
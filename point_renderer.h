@@ -0,0 +1,124 @@
+#pragma once
+
+#include <GL/glew.h>
+#include "shader_utils.h"
+#include "view_transform.h"
+
+// Instanced control-point renderer.
+//
+// Every point is the same static quad, placed by a per-instance center and
+// cut to a circle analytically in the fragment shader, so all points go out
+// in one glDrawArraysInstanced call. Centers come either from the renderer's
+// own buffer (setPoints/updatePoint) or from any buffer the caller already
+// keeps them in (drawInstances).
+class ControlPointRenderer {
+public:
+    void init() {
+        program = createProgram(vertexSource, fragmentSource);
+
+        const float corners[] = { -1.0f, -1.0f, 1.0f, -1.0f, -1.0f, 1.0f, 1.0f, 1.0f };
+        glGenVertexArrays(1, &vao);
+        glGenBuffers(1, &quadBuffer);
+        glGenBuffers(1, &instanceBuffer);
+
+        glBindVertexArray(vao);
+        glBindBuffer(GL_ARRAY_BUFFER, quadBuffer);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(corners), corners, GL_STATIC_DRAW);
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), nullptr);
+        glEnableVertexAttribArray(0);
+
+        glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), nullptr);
+        glVertexAttribDivisor(1, 1);
+        glEnableVertexAttribArray(1);
+        glBindVertexArray(0);
+    }
+
+    void destroy() {
+        glDeleteBuffers(1, &quadBuffer);
+        glDeleteBuffers(1, &instanceBuffer);
+        glDeleteVertexArrays(1, &vao);
+        glDeleteProgram(program);
+    }
+
+    // Replace all centers (interleaved x/y); storage only grows
+    void setPoints(const float* points, int count) {
+        glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+        if (count > capacity) {
+            capacity = count * 2;
+            glBufferData(GL_ARRAY_BUFFER, capacity * 2 * sizeof(float), nullptr, GL_DYNAMIC_DRAW);
+        }
+        if (count > 0) {
+            glBufferSubData(GL_ARRAY_BUFFER, 0, count * 2 * sizeof(float), points);
+        }
+        pointCount = count;
+    }
+
+    void updatePoint(int index, float x, float y) {
+        float center[2] = { x, y };
+        glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+        glBufferSubData(GL_ARRAY_BUFFER, index * 2 * sizeof(float), sizeof(center), center);
+    }
+
+    // World-to-screen mapping applied to the centers; the radius stays in screen units
+    void setView(const ViewTransform& transform) {
+        view = transform;
+    }
+
+    // Draw the points uploaded with setPoints
+    void draw(float radius, float aspect, float r, float g, float b) {
+        drawInstances(instanceBuffer, 0, pointCount, radius, aspect, r, g, b);
+    }
+
+    // Draw count points whose centers are stored at offset in buffer
+    void drawInstances(GLuint buffer, GLintptr offset, int count, float radius, float aspect, float r, float g, float b) {
+        if (count <= 0) return;
+        glUseProgram(program);
+        glUniform2f(glGetUniformLocation(program, "uRadius"), radius / aspect, radius);
+        setViewUniform(program, view);
+        glUniform3f(glGetUniformLocation(program, "uColor"), r, g, b);
+
+        glBindVertexArray(vao);
+        glBindBuffer(GL_ARRAY_BUFFER, buffer);
+        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (const void*)offset);
+        glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, count);
+        glBindVertexArray(0);
+    }
+
+private:
+    GLuint program = 0;
+    GLuint vao = 0;
+    GLuint quadBuffer = 0;
+    GLuint instanceBuffer = 0;
+    int capacity = 0;
+    int pointCount = 0;
+    ViewTransform view;
+
+    const char* vertexSource = R"(
+#version 330 core
+layout (location = 0) in vec2 corner;
+layout (location = 1) in vec2 center;
+uniform vec2 uRadius;
+uniform vec4 uView;
+out vec2 local;
+void main() {
+local = corner;
+gl_Position = vec4(center * uView.xy + uView.zw + corner * uRadius, 0.0, 1.0);
+}
+)";
+
+    // Unit circle inside the quad, with a one-pixel smooth edge
+    const char* fragmentSource = R"(
+#version 330 core
+in vec2 local;
+uniform vec3 uColor;
+out vec4 FragColor;
+void main() {
+float d = length(local);
+float edge = fwidth(d);
+float alpha = 1.0 - smoothstep(1.0 - edge, 1.0, d);
+if (alpha <= 0.0) discard;
+FragColor = vec4(uColor, alpha);
+}
+)";
+};
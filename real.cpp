@@ -3,28 +3,231 @@
 #include <iostream>
 #include <vector>
 #include <cmath>
+#include <chrono>
+#include <algorithm>
+#include <string>
+#include "bezier.h"
+#include "bezier_forward.h"
+#include "bezier_simd.h"
+#include "bernstein_cache.h"
+#include "bezier_adaptive.h"
+#include "composite_curve.h"
+#include "bezier_templates.h"
+#include "bezier_power.h"
+#include "shader_utils.h"
+#include "point_renderer.h"
+#include "stream_buffer.h"
+#include "bezier_quadratic.h"
+#include "sdf_curve_renderer.h"
+#include "stroke_renderer.h"
+#include "fill_renderer.h"
+#include "view_transform.h"
+#include "bezier_bounds.h"
+#include "async_tessellator.h"
+#include "point_grid.h"
+#include "bezier_bvh.h"
+#include "bezier_intersect.h"
+#include "arc_length.h"
+#include "curve_fit.h"
 
 const int WINDOW_WIDTH = 800;
 const int WINDOW_HEIGHT = 600;
-const int CURVE_RESOLUTION = 100;
-const int CIRCLE_SEGMENTS = 32; // Increased segments for smoother circles
+const float CURVE_TOLERANCE_PIXELS = 0.25f; // max distance from polyline to curve on screen
+const int MIN_CURVE_RESOLUTION = 8;
+const int MAX_CURVE_RESOLUTION = 16384;
+const int MIN_SEGMENT_RESOLUTION = 4;  // per composite segment
+const int MAX_SEGMENT_RESOLUTION = 1024;
+const int CULL_PIECES = 16; // pieces the global Bezier is cut into for culling
+const float MIN_ZOOM = 1.0f / 64.0f;
+const float MAX_ZOOM = 4096.0f;
+const int MAX_GPU_CONTROL_POINTS = 64; // must match MAX_POINTS in curveVertexShaderSource
+const float CONTROL_POINT_RADIUS = 0.015f;
+const float PICK_RADIUS = 0.03f; // GL units, the same at every zoom
+const float INTERSECTION_TOLERANCE_PIXELS = 0.01f;
+const float FIT_TOLERANCE_PIXELS = 2.0f;
 float M_PI = 3.14;
 
 std::vector<GLfloat> controlPoints;
 std::vector<GLfloat> curvePoints;
 
+// Curve evaluation engines, cycled with the E key
+enum class CurveEngine {
+	DeCasteljau,
+	ForwardDifference,
+	Simd,
+	BernsteinMatrix,
+	Adaptive,
+	Specialized,
+	PowerBasis,
+	ArcLength,
+	Count
+};
+
+const char* curveEngineName(CurveEngine engine) {
+	switch (engine) {
+	case CurveEngine::DeCasteljau: return "De Casteljau";
+	case CurveEngine::ForwardDifference: return "Forward differencing";
+	case CurveEngine::Simd: return "SIMD De Casteljau (" BEZIER_SIMD_NAME ")";
+	case CurveEngine::BernsteinMatrix: return "Cached Bernstein matrix";
+	case CurveEngine::Adaptive: return "Adaptive subdivision";
+	case CurveEngine::Specialized: return "Degree-specialized templates";
+	case CurveEngine::PowerBasis: return "Cached power basis (Horner)";
+	case CurveEngine::ArcLength: return "Arc-length spacing";
+	default: return "Unknown";
+	}
+}
+
+// Engines that emit resolution + 1 samples at t = i / resolution
+bool curveEngineIsUniform(CurveEngine engine) {
+	return engine != CurveEngine::Adaptive && engine != CurveEngine::ArcLength;
+}
+
+CurveEngine curveEngine = CurveEngine::ForwardDifference;
+ForwardDifferenceEvaluator forwardEvaluator;
+SimdBezierEvaluator simdEvaluator;
+AdaptiveTessellator adaptiveTessellator;
+std::vector<float> dispatchScratch;
+PowerBasisCurve powerCurve;
+ArcLengthTable arcLengthTable;
+
+// Global Bezier or a piecewise cubic chain, cycled with the B key
+CurveBasis curveBasis = CurveBasis::GlobalBezier;
+CompositeCurve compositeCurve;
+
+// Patch the curve with a rank-1 update while dragging instead of retessellating
+bool incrementalDrag = true;
+
 bool dragging = false;
 int draggedIndex = -1;
 
+// Control points indexed for picking; kept in step with every edit of controlPoints.
+// Dragged points snap onto the nearest other point within PICK_RADIUS (N key).
+PointGrid pointGrid(PICK_RADIUS);
+bool snapping = false;
+
+// Closest-point index over the curve itself, rebuilt on the first query after an edit.
+// Shift-click on the curve inserts a control point there.
+BezierBvh curveBvh;
+bool curveBvhValid = false;
+std::vector<float> segmentBeziers;
+
+// Points where the curve crosses itself, marked in yellow (X key); found on
+// the first frame after an edit
+bool showIntersections = false;
+bool intersectionsValid = false;
+BezierIntersector intersector;
+std::vector<CurveIntersection> selfIntersections;
+std::vector<float> intersectionMarkers;
+ControlPointRenderer markerRenderer;
+
+// Freehand capture (H key): dragging over empty space records the raw cursor
+// stream, which is fitted with piecewise cubic Beziers on release and
+// replaces the control points
+bool freehand = false;
+bool capturing = false;
+bool strokeDirty = false;
+std::vector<float> strokeSamples;
+StreamAllocation strokeAllocation;
+BezierFitter strokeFitter;
+
+// Pan/zoom camera: control points are in world coordinates, which match GL
+// coordinates at the default view. Scroll zooms, middle drag pans, Home resets.
+ViewTransform view;
+bool panning = false;
+float panX = 0.0f, panY = 0.0f;
+
+// Samples of the global Bezier for the current view, chosen at every rebuild
+int curveResolution = 100;
+// Parts of the curve were left out as off screen, so curvePoints is not uniform
+bool curveCulled = false;
+std::vector<float> cullRemaining, cullPiece, cullWork, cullSamples;
+
+// Everything a curve rebuild reads, copied so the worker never sees later edits
+struct CurveJob {
+	std::vector<GLfloat> points;
+	CurveBasis basis = CurveBasis::GlobalBezier;
+	CurveEngine engine = CurveEngine::ForwardDifference;
+	ViewTransform view;
+	float strokeWidth = 2.0f;
+};
+
+// What a rebuild produces
+struct CurveResult {
+	std::vector<GLfloat> points;
+	int resolution = 0;
+	bool culled = false;
+	AdaptiveStats adaptive;
+};
+
+// Full rebuilds run on a worker thread (A key) while the last finished curve
+// stays on screen. The engines above and compositeCurve belong to the worker
+// until it is idle; drag patches only run then.
+bool asyncRebuild = true;
+AsyncTessellator<CurveResult> curveWorker;
+CurveResult finishedCurve;
+
+// Edits recorded by the input callbacks and applied once per frame.
+// Cursor events only overwrite the pending drag target, so any number of
+// them between two frames costs a single tessellate-plus-upload step.
+struct EditQueue {
+	bool rebuild = false;        // points added/removed or settings changed
+	bool dragPending = false;
+	int dragIndex = -1;
+	float dragX = 0.0f, dragY = 0.0f;
+	bool reportAdaptive = false; // print adaptive stats after the next rebuild
+
+	// Counters since the last report
+	int events = 0;
+	int updates = 0;
+	int frames = 0;
+	std::chrono::steady_clock::time_point lastReport = std::chrono::steady_clock::now();
+};
+EditQueue edits;
+
+// The loop sleeps in glfwWaitEvents until something marks the view dirty
+bool needsRedraw = true;
+
+// Bounding box of everything drawn, in GL coordinates
+struct ViewBounds {
+	float minX = 1.0f, minY = 1.0f, maxX = -1.0f, maxY = -1.0f;
+
+	bool empty() const { return minX > maxX || minY > maxY; }
+
+	void add(float x, float y) {
+		minX = std::min(minX, x);
+		minY = std::min(minY, y);
+		maxX = std::max(maxX, x);
+		maxY = std::max(maxY, y);
+	}
+
+	void add(const ViewBounds& other) {
+		if (other.empty()) return;
+		add(other.minX, other.minY);
+		add(other.maxX, other.maxY);
+	}
+};
+
+// Scissor redraws to the damaged region (D key). The back buffer may hold
+// either of the two previous frames after a swap, so the damage is the union
+// of what this frame and the last two frames drew.
+bool damageTracking = false;
+ViewBounds drawnBounds[2];
+int fullRedraws = 2; // frames left to redraw whole, after resizes and toggles
+
 GLFWwindow* window;
-GLuint vao[3], vbo[3];
+GLuint lineVAO;
+StreamBuffer streamBuffer;
+StreamAllocation pointAllocation, curveAllocation, quadraticAllocation, fillAllocation;
+bool pointsDirty = true, curveDirty = true;
+ControlPointRenderer pointRenderer;
 GLuint shaderProgram;
 
 const char* vertexShaderSource = R"(
 #version 330 core
 layout (location = 0) in vec2 position;
+uniform vec4 uView;
 void main() {
-gl_Position = vec4(position, 0.0, 1.0);
+gl_Position = vec4(position * uView.xy + uView.zw, 0.0, 1.0);
 }
 )";
 
@@ -37,32 +240,66 @@ FragColor = vec4(uColor, 1.0);
 }
 )";
 
-// Compile shader
-GLuint compileShader(GLenum type, const char* src) {
-	GLuint shader = glCreateShader(type);
-	glShaderSource(shader, 1, &src, nullptr);
-	glCompileShader(shader);
+// Evaluates the Bezier at t = gl_VertexID / uResolution; drawn without vertex attributes.
+// The Bernstein weights C(n, i) t^i (1 - t)^(n - i) are built one from the
+// next, mirroring t > 0.5 onto the reversed polygon so the ratio t / (1 - t)
+// stays <= 1. No local array: a vec2[64] De Casteljau triangle came out
+// constant under llvmpipe.
+const char* curveVertexShaderSource = R"(
+#version 330 core
+const int MAX_POINTS = 64;
+uniform vec2 uControlPoints[MAX_POINTS];
+uniform int uCount;
+uniform int uResolution;
+uniform vec4 uView;
+void main() {
+float t = float(gl_VertexID) / float(uResolution);
+bool mirrored = t > 0.5;
+float a = mirrored ? 1.0 - t : t;
+float ratio = a / (1.0 - a);
+int n = uCount - 1;
+float weight = pow(1.0 - a, float(n));
+vec2 p = vec2(0.0);
+for (int i = 0; i <= n; ++i) {
+	p += weight * uControlPoints[mirrored ? n - i : i];
+	weight *= ratio * float(n - i) / float(i + 1);
+}
+gl_Position = vec4(p * uView.xy + uView.zw, 0.0, 1.0);
+}
+)";
+// Evaluate the curve in the vertex shader so edits only upload the control points
+bool gpuCurve = false;
+GLuint gpuCurveProgram;
+GLuint gpuCurveVAO;
 
-	// Check for shader compile errors
-	GLint success;
-	GLchar infoLog[512];
-	glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
-	if (!success) {
-		glGetShaderInfoLog(shader, 512, NULL, infoLog);
-		std::cerr << "Shader compilation error: " << infoLog << std::endl;
-	}
+// Draw the curve as analytic distance-field strokes over quadratic pieces (S key)
+bool sdfCurve = false;
+float strokeWidth = 2.0f; // pixels
+QuadraticApproximator curveQuadratics;
+SdfCurveRenderer sdfRenderer;
+std::vector<float> quadraticScratch;
 
-	return shader;
-}
+// Thick curve and control polygon expanded on the GPU (T key); width with +/-
+bool thickStrokes = false;
+StrokeJoin strokeJoin = StrokeJoin::Round;
+StrokeCap strokeCap = StrokeCap::Round;
+StrokeRenderer strokeRenderer;
+const float MIN_STROKE_WIDTH = 1.0f;
+const float MAX_STROKE_WIDTH = 64.0f;
+
+// Fill the shape closed by the chord from the last to the first point (F key)
+bool fillShape = false;
+FillRenderer fillRenderer;
+std::vector<float> fillTriangles;
 
 // De Casteljau's algorithm
-std::vector<GLfloat> computeBezierCurve(const std::vector<GLfloat>& points) {
+std::vector<GLfloat> computeBezierCurve(const std::vector<GLfloat>& points, int resolution) {
 	std::vector<GLfloat> curve;
 	int n = points.size() / 2 - 1;
 	if (n < 1) return curve;
 
-	for (int i = 0; i <= CURVE_RESOLUTION; ++i) {
-		float t = i / (float)CURVE_RESOLUTION;
+	for (int i = 0; i <= resolution; ++i) {
+		float t = i / (float)resolution;
 		std::vector<float> temp(points);
 		for (int r = 1; r <= n; ++r)
 			for (int j = 0; j <= n - r; ++j) {
@@ -75,98 +312,749 @@ std::vector<GLfloat> computeBezierCurve(const std::vector<GLfloat>& points) {
 	return curve;
 }
 
-// Coordinate conversion
-void screenToGLCoords(double x, double y, float& outX, float& outY) {
+// Pixels per world unit along x and y at the zoom of v
+float pixelsPerUnitX(const ViewTransform& v) {
+	return 0.5f * WINDOW_WIDTH * v.scale;
+}
+
+float pixelsPerUnitY(const ViewTransform& v) {
+	return 0.5f * WINDOW_HEIGHT * v.scale;
+}
+
+// CURVE_TOLERANCE_PIXELS in world units, for the adaptive and quadratic approximations
+float curveTolerance(const ViewTransform& v) {
+	return CURVE_TOLERANCE_PIXELS / std::max(pixelsPerUnitX(v), pixelsPerUnitY(v));
+}
+
+// Uniform samples that keep a Bezier within CURVE_TOLERANCE_PIXELS of its polyline in view v
+int samplesOnScreen(const ViewTransform& v, const float* points, int count, int minSegments, int maxSegments) {
+	return bezierSegmentsForTolerance(points, count, pixelsPerUnitX(v), pixelsPerUnitY(v), CURVE_TOLERANCE_PIXELS,
+		minSegments, maxSegments);
+}
+
+// Tessellate the control polygon with the given engine into out; uniform engines emit resolution + 1 samples
+void tessellateCurve(CurveEngine engine, const std::vector<GLfloat>& points, int resolution, float tolerance,
+	std::vector<GLfloat>& out) {
+	int count = points.size() / 2;
+	if (count < 2) {
+		out.clear();
+		return;
+	}
+
+	switch (engine) {
+	case CurveEngine::ForwardDifference:
+		forwardEvaluator.setControlPoints(points.data(), count);
+		// resize keeps the capacity, so steady-state edits do not allocate
+		out.resize(2 * (resolution + 1));
+		forwardEvaluator.evaluate(resolution, out.data());
+		break;
+	case CurveEngine::Simd:
+		simdEvaluator.setControlPoints(points.data(), count);
+		out.resize(2 * (resolution + 1));
+		simdEvaluator.evaluateUniform(resolution, out.data());
+		break;
+	case CurveEngine::BernsteinMatrix: {
+		std::shared_ptr<const BernsteinTable> basis = sharedBernsteinCache().get(count - 1, resolution + 1);
+		out.resize(2 * (resolution + 1));
+		tessellateWithBasis(*basis, points.data(), out.data());
+		break;
+	}
+	case CurveEngine::Adaptive:
+		adaptiveTessellator.tessellate(points.data(), count, tolerance, out);
+		break;
+	case CurveEngine::Specialized:
+		dispatchScratch.resize(points.size());
+		out.resize(2 * (resolution + 1));
+		evaluateBezierDispatch(points.data(), count, 2, resolution, out.data(), dispatchScratch.data());
+		break;
+	case CurveEngine::PowerBasis:
+		// Coefficients are only rebuilt when the control points differ from the cached ones
+		powerCurve.setControlPoints(points.data(), count);
+		out.resize(2 * (resolution + 1));
+		powerCurve.evaluateUniform(resolution, out.data());
+		break;
+	case CurveEngine::ArcLength: {
+		// The table is only rebuilt when the control points changed. Even
+		// spacing loses to uniform t when curvature bunches up where the
+		// curve is slow, near cusps; then the uniform samples are cheaper.
+		arcLengthTable.setControlPoints(points.data(), count);
+		int segments = arcLengthTable.segmentsForTolerance(tolerance, 1, MAX_CURVE_RESOLUTION);
+		if (segments > resolution) {
+			tessellateCurve(CurveEngine::ForwardDifference, points, resolution, tolerance, out);
+			break;
+		}
+		arcLengthTable.tessellateEvenly(segments, out);
+		break;
+	}
+	default:
+		out = computeBezierCurve(points, resolution);
+		break;
+	}
+}
+
+// Window pixels to GL coordinates
+void cursorToScreen(double x, double y, float& outX, float& outY) {
 	outX = 2.0f * (float)x / WINDOW_WIDTH - 1.0f;
 	outY = 1.0f - 2.0f * (float)y / WINDOW_HEIGHT;
 }
 
+// Window pixels to world coordinates through the current view
+void screenToGLCoords(double x, double y, float& outX, float& outY) {
+	float screenX, screenY;
+	cursorToScreen(x, y, screenX, screenY);
+	view.toWorld(screenX, screenY, outX, outY);
+}
+
+// World rectangle visible in the job's view, grown by the stroke half width and anti-aliasing
+void cullRect(const CurveJob& job, float& minX, float& minY, float& maxX, float& maxY) {
+	job.view.visibleRect(minX, minY, maxX, maxY);
+	float marginPixels = 0.5f * std::max(job.strokeWidth, 2.0f) + 2.0f;
+	minX -= marginPixels / pixelsPerUnitX(job.view);
+	maxX += marginPixels / pixelsPerUnitX(job.view);
+	minY -= marginPixels / pixelsPerUnitY(job.view);
+	maxY += marginPixels / pixelsPerUnitY(job.view);
+}
+
+// The global Bezier's sample count from its size on screen
+int bezierResolution(const std::vector<GLfloat>& points, const ViewTransform& v) {
+	int count = points.size() / 2;
+	return count >= 2
+		? samplesOnScreen(v, points.data(), count, MIN_CURVE_RESOLUTION, MAX_CURVE_RESOLUTION)
+		: MIN_CURVE_RESOLUTION;
+}
+
+// Tessellate only the parts of the global Bezier that can reach the screen.
+// The curve is cut into CULL_PIECES pieces; a piece whose exact bounds miss
+// the view contributes just its end point, a visible one is tessellated with
+// the job's engine at its own on-screen sample count. Returns false, and
+// leaves out alone, when the whole curve is in view.
+bool tessellateVisibleBezier(const CurveJob& job, std::vector<GLfloat>& out, const CancelToken& token) {
+	const std::vector<GLfloat>& points = job.points;
+	int count = points.size() / 2;
+	if (count < 2) return false;
+	float minX, minY, maxX, maxY;
+	cullRect(job, minX, minY, maxX, maxY);
+	BezierBounds visible;
+	visible.reset(minX, minY);
+	visible.add(maxX, maxY);
+	if (visible.contains(controlBounds(points.data(), count))) return false;
+
+	float tolerance = curveTolerance(job.view);
+	cullRemaining = points;
+	cullPiece.resize(points.size());
+	cullWork.resize(points.size());
+	out.assign(points.begin(), points.begin() + 2);
+	for (int k = 0; k < CULL_PIECES && !token.cancelled(); ++k) {
+		// Cutting what remains at 1 / (pieces left) gives equal parameter steps
+		if (k < CULL_PIECES - 1) {
+			splitBezier(cullRemaining.data(), count, 1.0f / (CULL_PIECES - k), cullPiece.data(), cullRemaining.data(),
+				cullWork.data());
+		}
+		else {
+			cullPiece = cullRemaining;
+		}
+		BezierBounds bounds = bezierBounds(cullPiece.data(), count, tolerance);
+		if (!bounds.overlaps(minX, minY, maxX, maxY)) {
+			out.push_back(cullPiece[2 * count - 2]);
+			out.push_back(cullPiece[2 * count - 1]);
+			continue;
+		}
+		int resolution = samplesOnScreen(job.view, cullPiece.data(), count, 1, MAX_CURVE_RESOLUTION);
+		tessellateCurve(job.engine, cullPiece, resolution, tolerance, cullSamples);
+		out.insert(out.end(), cullSamples.begin() + 2, cullSamples.end());
+	}
+	return true;
+}
+
+// Tessellate the job's curve for its basis and view. Runs on the worker when
+// asyncRebuild is on; returns false if a newer job cancelled it.
+bool rebuildCurve(const CurveJob& job, CurveResult& result, const CancelToken& token) {
+	int count = job.points.size() / 2;
+	result.resolution = bezierResolution(job.points, job.view);
+	result.culled = false;
+	if (job.basis == CurveBasis::GlobalBezier) {
+		result.culled = tessellateVisibleBezier(job, result.points, token);
+		if (!result.culled) {
+			tessellateCurve(job.engine, job.points, result.resolution, curveTolerance(job.view), result.points);
+		}
+		result.adaptive = adaptiveTessellator.lastStats();
+		return !token.cancelled();
+	}
+
+	// One resolution for every segment, enough for the largest one on screen
+	float minX, minY, maxX, maxY;
+	cullRect(job, minX, minY, maxX, maxY);
+	compositeCurve.setBasis(job.basis);
+	int resolution = MIN_SEGMENT_RESOLUTION;
+	float bezier[8];
+	for (int s = 0; s < compositeCurve.segmentCountFor(count); ++s) {
+		compositeCurve.segmentBezier(job.points.data(), count, s, bezier);
+		if (bezierBounds(bezier, 4).overlaps(minX, minY, maxX, maxY)) {
+			resolution = std::max(resolution,
+				samplesOnScreen(job.view, bezier, 4, MIN_SEGMENT_RESOLUTION, MAX_SEGMENT_RESOLUTION));
+		}
+	}
+	if (token.cancelled()) return false;
+	compositeCurve.setSegmentResolution(resolution);
+	compositeCurve.setCullRect(minX, minY, maxX, maxY);
+	compositeCurve.rebuild(job.points.data(), count);
+	result.points = compositeCurve.vertices();
+	return !token.cancelled();
+}
+
+CurveJob snapshotCurve() {
+	CurveJob job;
+	job.points = controlPoints;
+	job.basis = curveBasis;
+	job.engine = curveEngine;
+	job.view = view;
+	job.strokeWidth = strokeWidth;
+	return job;
+}
+
+// Show a finished rebuild; swaps, so result keeps the old storage for reuse
+void applyCurveResult(CurveResult& result) {
+	curvePoints.swap(result.points);
+	curveResolution = result.resolution;
+	curveCulled = result.culled;
+	curveDirty = true;
+	needsRedraw = true;
+	if (edits.reportAdaptive) {
+		std::cout << "  " << result.adaptive.vertices << " vertices (fixed step: " << curveResolution + 1
+			<< "), max depth " << result.adaptive.maxDepth << std::endl;
+		edits.reportAdaptive = false;
+	}
+}
+
+// Pick up the worker's newest curve, if one finished since the last call
+void collectCurveResult() {
+	if (curveWorker.takeResult(finishedCurve)) {
+		applyCurveResult(finishedCurve);
+	}
+}
+
+// Whether the worker is done with everything posted and curvePoints shows its last job
+bool curveSettled() {
+	if (!curveWorker.idle()) return false;
+	collectCurveResult();
+	return true;
+}
+
+// Time every engine on the current curve and report its deviation from De Casteljau
+void compareCurveEngines() {
+	// The engines are the worker's while it runs
+	curveWorker.wait();
+	collectCurveResult();
+	const int iterations = 200;
+	std::vector<GLfloat> reference = computeBezierCurve(controlPoints, curveResolution);
+	std::vector<GLfloat> result;
+
+	std::cout << "Curve engines, " << controlPoints.size() / 2 << " control points, "
+		<< curveResolution + 1 << " samples:" << std::endl;
+	for (int e = 0; e < (int)CurveEngine::Count; ++e) {
+		CurveEngine engine = (CurveEngine)e;
+		auto start = std::chrono::steady_clock::now();
+		for (int i = 0; i < iterations; ++i) {
+			tessellateCurve(engine, controlPoints, curveResolution, curveTolerance(view), result);
+		}
+		auto end = std::chrono::steady_clock::now();
+		double micros = std::chrono::duration<double, std::micro>(end - start).count() / iterations;
+
+		std::cout << "  " << curveEngineName(engine) << ": " << micros << " us, "
+			<< result.size() / 2 << " vertices";
+		if (curveEngineIsUniform(engine)) {
+			float maxError = 0.0f;
+			for (size_t i = 0; i < result.size() && i < reference.size(); ++i) {
+				maxError = std::fmax(maxError, std::fabs(result[i] - reference[i]));
+			}
+			std::cout << ", max error " << maxError;
+		}
+		std::cout << std::endl;
+	}
+}
+
+// Whether the curve is currently evaluated by curveVertexShaderSource
+bool gpuCurveActive() {
+	int count = controlPoints.size() / 2;
+	return gpuCurve && curveBasis == CurveBasis::GlobalBezier && count >= 2 && count <= MAX_GPU_CONTROL_POINTS;
+}
+
+// Upload the control points to the GPU curve program, O(n) bytes per edit
+void uploadGpuCurve() {
+	curveResolution = bezierResolution(controlPoints, view);
+	glUseProgram(gpuCurveProgram);
+	glUniform2fv(glGetUniformLocation(gpuCurveProgram, "uControlPoints"), controlPoints.size() / 2, controlPoints.data());
+	glUniform1i(glGetUniformLocation(gpuCurveProgram, "uCount"), controlPoints.size() / 2);
+	glUniform1i(glGetUniformLocation(gpuCurveProgram, "uResolution"), curveResolution);
+}
+
+// Everything derived lazily from the exact curve is stale
+void curveGeometryChanged() {
+	curveBvhValid = false;
+	intersectionsValid = false;
+}
+
 // Update buffers
 void updateBuffers() {
-	curvePoints = computeBezierCurve(controlPoints);
-	glBindBuffer(GL_ARRAY_BUFFER, vbo[0]);
-	glBufferData(GL_ARRAY_BUFFER, controlPoints.size() * sizeof(float), controlPoints.data(), GL_DYNAMIC_DRAW);
-	glBindBuffer(GL_ARRAY_BUFFER, vbo[1]);
-	glBufferData(GL_ARRAY_BUFFER, controlPoints.size() * sizeof(float), controlPoints.data(), GL_DYNAMIC_DRAW);
-	glBindBuffer(GL_ARRAY_BUFFER, vbo[2]);
-	glBufferData(GL_ARRAY_BUFFER, curvePoints.size() * sizeof(float), curvePoints.data(), GL_DYNAMIC_DRAW);
+	pointsDirty = true;
+	curveGeometryChanged();
+
+	// The GPU path never touches the sample buffer
+	if (gpuCurveActive()) {
+		uploadGpuCurve();
+		return;
+	}
+	if (asyncRebuild) {
+		// Posting drops an untaken result, and during a drag that is the only one arriving
+		collectCurveResult();
+		CurveJob job = snapshotCurve();
+		curveWorker.post([job](CurveResult& result, const CancelToken& token) {
+			return rebuildCurve(job, result, token);
+		});
+		return;
+	}
+	// Inline, but the worker may still own the engines from an earlier job
+	curveWorker.wait();
+	collectCurveResult();
+	rebuildCurve(snapshotCurve(), finishedCurve, CancelToken());
+	applyCurveResult(finishedCurve);
 }
 
-// Generate vertices for a perfect circle
-std::vector<GLfloat> generateCircleVertices(float centerX, float centerY, float radius) {
-	std::vector<GLfloat> vertices;
-	float aspect = (float)WINDOW_WIDTH / WINDOW_HEIGHT;
+// Approximate the exact curve (not its polyline) by quadratic pieces for the SDF renderer
+void updateCurveQuadratics() {
+	curveQuadratics.clear();
+	int count = controlPoints.size() / 2;
+	if (count < 2) return;
 
-	vertices.reserve(2 * (CIRCLE_SEGMENTS + 2));
-	vertices.push_back(centerX);
-	vertices.push_back(centerY);
+	if (curveBasis == CurveBasis::GlobalBezier) {
+		quadraticScratch.resize(2 * count);
+		auto curve = [&](float t, float& x, float& y) {
+			deCasteljauPoint(controlPoints.data(), count, t, quadraticScratch.data(), x, y);
+		};
+		curveQuadratics.append(curve, 0.0f, 1.0f, curveTolerance(view), count - 1);
+		return;
+	}
+	// Stateless evaluation: compositeCurve may be in use by the worker
+	for (int s = 0; s < compositeSegmentCount(curveBasis, count); ++s) {
+		auto curve = [&](float t, float& x, float& y) {
+			evaluateCompositeSegment(curveBasis, controlPoints.data(), count, s, t, x, y);
+		};
+		curveQuadratics.append(curve, 0.0f, 1.0f, curveTolerance(view));
+	}
+}
 
-	for (int i = 0; i <= CIRCLE_SEGMENTS; i++) {
-		float angle = 2.0f * M_PI * i / CIRCLE_SEGMENTS;
-		float x = centerX + radius * cosf(angle) / aspect;
-		float y = centerY + radius * sinf(angle);
-		vertices.push_back(x);
-		vertices.push_back(y);
+// Write one block if it changed or its region was recycled
+void streamBlock(StreamAllocation& allocation, const std::vector<float>& data, bool dirty) {
+	if ((dirty || !streamBuffer.isLive(allocation)) && !data.empty()) {
+		allocation = streamBuffer.write(data.data(), data.size() * sizeof(float));
 	}
+}
 
-	return vertices;
+// Copy changed (or recycled) vertex data into the stream buffer; called once per frame
+void streamVertexData() {
+	bool quadraticsDirty = (sdfCurve || fillShape) && pointsDirty;
+	if (quadraticsDirty) {
+		updateCurveQuadratics();
+		if (fillShape) {
+			buildFillTriangles(curveQuadratics.quadratics(), fillTriangles);
+		}
+	}
+	// Room for every block drawn this frame first: a write that had to orphan
+	// or grow the buffer would drop the blocks written before it
+	struct StreamBlock {
+		StreamAllocation& allocation;
+		const std::vector<float>& data;
+		bool drawn;
+		bool dirty;
+	};
+	StreamBlock blocks[] = {
+		{ pointAllocation, controlPoints, true, pointsDirty },
+		{ curveAllocation, curvePoints, !gpuCurveActive(), curveDirty },
+		{ quadraticAllocation, curveQuadratics.quadratics(), sdfCurve, quadraticsDirty },
+		{ fillAllocation, fillTriangles, fillShape, quadraticsDirty },
+		{ strokeAllocation, strokeSamples, capturing, strokeDirty },
+	};
+	GLsizeiptr bytes = 0;
+	for (const StreamBlock& block : blocks) {
+		if (block.drawn) bytes += StreamBuffer::alignedSize(block.data.size() * sizeof(float));
+	}
+	streamBuffer.reserve(bytes);
+	for (StreamBlock& block : blocks) {
+		if (block.drawn) streamBlock(block.allocation, block.data, block.dirty);
+	}
+	pointsDirty = curveDirty = strokeDirty = false;
 }
 
+// Draw count points of an interleaved x/y block in the stream buffer
+void drawStreamed(GLenum mode, const StreamAllocation& allocation, int count) {
+	if (count <= 0 || !allocation.valid) return;
+	glBindVertexArray(lineVAO);
+	glBindBuffer(GL_ARRAY_BUFFER, streamBuffer.buffer());
+	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), nullptr);
+	// Allocations are 16-byte aligned, so the offset is a whole number of vertices
+	glDrawArrays(mode, allocation.offset / (2 * sizeof(float)), count);
+}
 
-// Draw a perfect circle at the specified position
-void drawCircle(float centerX, float centerY, float radius) {
-	std::vector<GLfloat> circleVertices = generateCircleVertices(centerX, centerY, radius);
+// Move one control point and update only the part of the curve it affects:
+// the segments it supports for composite curves, or B_i(t) * delta for the global Bezier
+void moveControlPoint(int index, float x, float y) {
+	int count = controlPoints.size() / 2;
+	curveGeometryChanged();
+	if (gpuCurveActive()) {
+		controlPoints[index * 2] = x;
+		controlPoints[index * 2 + 1] = y;
+		pointsDirty = true;
+		uploadGpuCurve();
+		return;
+	}
 
-	GLuint tempVAO, tempVBO;
-	glGenVertexArrays(1, &tempVAO);
-	glGenBuffers(1, &tempVBO);
+	bool composite = curveBasis != CurveBasis::GlobalBezier;
+	// Patches edit the worker's last result in place, so only once it is idle
+	bool patchable = curveSettled() && (composite
+		? curvePoints.size() == compositeCurve.vertices().size()
+		: incrementalDrag && curveEngineIsUniform(curveEngine) && count >= 2 && !curveCulled
+			&& curvePoints.size() == (size_t)(2 * (curveResolution + 1)));
+	if (!patchable) {
+		controlPoints[index * 2] = x;
+		controlPoints[index * 2 + 1] = y;
+		updateBuffers();
+		return;
+	}
 
-	glBindVertexArray(tempVAO);
-	glBindBuffer(GL_ARRAY_BUFFER, tempVBO);
-	glBufferData(GL_ARRAY_BUFFER, circleVertices.size() * sizeof(float),
-		circleVertices.data(), GL_STATIC_DRAW);
+	float dx = x - controlPoints[index * 2];
+	float dy = y - controlPoints[index * 2 + 1];
+	controlPoints[index * 2] = x;
+	controlPoints[index * 2 + 1] = y;
 
-	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), nullptr);
-	glEnableVertexAttribArray(0);
+	pointsDirty = true;
+
+	int first, last;
+	bool changed;
+	if (composite) {
+		changed = compositeCurve.updatePoint(controlPoints.data(), index, first, last);
+		if (changed) {
+			const std::vector<float>& vertices = compositeCurve.vertices();
+			std::copy(vertices.begin() + first * 2, vertices.begin() + (last + 1) * 2, curvePoints.begin() + first * 2);
+		}
+	}
+	else {
+		std::shared_ptr<const BernsteinTable> basis = sharedBernsteinCache().get(count - 1, curveResolution + 1);
+		changed = applyControlPointDelta(*basis, index, dx, dy, curvePoints.data(), first, last);
+	}
+	if (changed) {
+		curveDirty = true;
+	}
+}
 
-	glDrawArrays(GL_TRIANGLE_FAN, 0, circleVertices.size() / 2);
+// Find the nearest point under the cursor; threshold is in GL units, so it does not change with the zoom
+int findPointUnderCursor(float x, float y, float threshold = PICK_RADIUS, int exclude = -1) {
+	return pointGrid.nearest(x, y, threshold / view.scale, exclude);
+}
 
-	// Cleanup
-	glDisableVertexAttribArray(0);
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
-	glBindVertexArray(0);
-	glDeleteBuffers(1, &tempVBO);
-	glDeleteVertexArrays(1, &tempVAO);
+// The composite segments of the current basis as cubic Beziers, back to back
+// in segmentBeziers; returns the segment count
+int buildSegmentBeziers() {
+	int count = controlPoints.size() / 2;
+	int segments = compositeSegmentCount(curveBasis, count);
+	segmentBeziers.resize(8 * segments);
+	for (int s = 0; s < segments; ++s) {
+		compositeSegmentBezier(curveBasis, controlPoints.data(), count, s, &segmentBeziers[s * 8]);
+	}
+	return segments;
 }
 
+// Index the exact curve for the current basis: the global Bezier, or the
+// composite segments converted to cubic Beziers
+void buildCurveBvh() {
+	if (curveBasis == CurveBasis::GlobalBezier) {
+		curveBvh.build(controlPoints.data(), controlPoints.size() / 2);
+		return;
+	}
+	int segments = buildSegmentBeziers();
+	curveBvh.buildChain(segmentBeziers.data(), segments, 4, 8);
+}
 
+// Find where the curve crosses itself and upload the markers. The global
+// Bezier is cut into as many pieces as the BVH uses, composite segments into
+// four, so no piece is long enough to loop on itself.
+void updateIntersections(bool report) {
+	if (!showIntersections || intersectionsValid) return;
+	intersectionsValid = true;
+	int count = controlPoints.size() / 2;
+	selfIntersections.clear();
+	float tolerance = INTERSECTION_TOLERANCE_PIXELS / std::max(pixelsPerUnitX(view), pixelsPerUnitY(view));
 
-// Get distance between a point and position
-float getPointDistance(int pointIndex, float x, float y) {
-	float dx = controlPoints[pointIndex * 2] - x;
-	float dy = controlPoints[pointIndex * 2 + 1] - y;
-	return dx * dx + dy * dy;
+	auto start = std::chrono::steady_clock::now();
+	if (count >= 3 && curveBasis == CurveBasis::GlobalBezier) {
+		int pieces = std::min(256, std::max(4, 4 * (count - 1)));
+		intersector.selfIntersections(controlPoints.data(), 1, count, pieces, tolerance, selfIntersections);
+	}
+	else if (count >= 3) {
+		int segments = buildSegmentBeziers();
+		intersector.selfIntersections(segmentBeziers.data(), segments, 4, 4, tolerance, selfIntersections);
+	}
+	auto end = std::chrono::steady_clock::now();
+
+	intersectionMarkers.clear();
+	for (const CurveIntersection& hit : selfIntersections) {
+		intersectionMarkers.push_back(hit.x);
+		intersectionMarkers.push_back(hit.y);
+	}
+	markerRenderer.setPoints(intersectionMarkers.data(), selfIntersections.size());
+	if (report) {
+		std::cout << selfIntersections.size() << " self-intersections in "
+			<< std::chrono::duration<double, std::micro>(end - start).count() << " us ("
+			<< intersector.lastPairsTested() << " piece pairs past the broad phase"
+			<< (intersector.lastTruncated() ? ", overlapping pieces cut short" : "") << ")" << std::endl;
+	}
 }
 
-// Find point under cursor
-int findPointUnderCursor(float x, float y, float threshold = 0.03f) {
-	for (int i = 0; i < controlPoints.size() / 2; ++i) {
-		if (getPointDistance(i, x, y) < threshold * threshold) {
-			return i;
+// Insert a control point where the curve passes within the pick radius of
+// (x, y); returns its index, or -1 if the curve is not there.
+//
+// For the global Bezier the picked curve point becomes a control point at the
+// index whose Greville abscissa i / (n + 1) is nearest t. That raises the
+// degree and shifts every Bernstein weight, so the whole curve changes, not
+// just the part near t; the point only gives the user a handle where they
+// clicked. Use the piecewise Bezier basis to keep the shape. Piecewise
+// Beziers split the picked segment exactly, into two that share the new
+// point. Other composite segments get the point inserted between the two
+// points the segment spans.
+int insertPointOnCurve(float x, float y) {
+	int count = controlPoints.size() / 2;
+	if (count < 2) return -1;
+	if (!curveBvhValid) {
+		buildCurveBvh();
+		curveBvhValid = true;
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	CurveHit hit = curveBvh.closestPoint(x, y, PICK_RADIUS / view.scale);
+	auto end = std::chrono::steady_clock::now();
+	if (!hit.found) return -1;
+
+	int index;
+	float px = hit.x, py = hit.y;
+	if (curveBasis == CurveBasis::GlobalBezier) {
+		int n = count - 1;
+		index = std::min(n, std::max(1, (int)std::floor(hit.t * (n + 1) + 0.5f)));
+	}
+	else if (curveBasis == CurveBasis::PiecewiseBezier) {
+		int s = std::min((int)hit.t, compositeSegmentCount(curveBasis, count) - 1);
+		float left[8], right[8], work[8];
+		splitBezier(&controlPoints[6 * s], 4, hit.t - s, left, right, work);
+		// P0 a b P3 becomes P0 l1 l2 M r1 r2 P3
+		controlPoints.erase(controlPoints.begin() + 6 * s + 2, controlPoints.begin() + 6 * s + 6);
+		controlPoints.insert(controlPoints.begin() + 6 * s + 2, { left[2], left[3], left[4], left[5], left[6], left[7],
+			right[2], right[3], right[4], right[5] });
+		pointGrid.build(controlPoints.data(), controlPoints.size() / 2);
+		std::cout << "Split segment " << s << " at t = " << hit.t - s << std::endl;
+		return 3 * s + 3;
+	}
+	else {
+		int s = std::min((int)hit.t, compositeSegmentCount(curveBasis, count) - 1);
+		index = std::min(count, std::max(0, compositeFirstPoint(curveBasis, s) + 2));
+	}
+	controlPoints.insert(controlPoints.begin() + index * 2, { px, py });
+	pointGrid.insert(index, px, py);
+	std::cout << "Inserted point " << index << " at t = " << hit.t << " (" << hit.distance * view.scale
+		<< " GL units from the cursor, query "
+		<< std::chrono::duration<double, std::micro>(end - start).count() << " us)" << std::endl;
+	return index;
+}
+
+// Queue a full rebuild for the next frame
+void requestRebuild() {
+	edits.rebuild = true;
+	++edits.events;
+	needsRedraw = true;
+}
+
+// Apply everything queued since the last frame: at most one retessellation
+void applyPendingEdits() {
+	if (edits.dragPending) {
+		edits.dragPending = false;
+		if (edits.dragIndex >= 0 && edits.dragIndex < (int)controlPoints.size() / 2) {
+			if (edits.rebuild) {
+				controlPoints[edits.dragIndex * 2] = edits.dragX;
+				controlPoints[edits.dragIndex * 2 + 1] = edits.dragY;
+			}
+			else {
+				moveControlPoint(edits.dragIndex, edits.dragX, edits.dragY);
+				++edits.updates;
+			}
+			pointGrid.move(edits.dragIndex, edits.dragX, edits.dragY);
 		}
 	}
-	return -1; // No point found
+	if (edits.rebuild) {
+		edits.rebuild = false;
+		updateBuffers();
+		++edits.updates;
+	}
+}
+
+// Mark the whole window for the next redraws
+void invalidateView() {
+	needsRedraw = true;
+	fullRedraws = 2;
+}
+
+// Region the current frame draws into, in GL coordinates. The GPU curve is
+// not on the CPU, but a Bezier curve stays inside the hull of its control points.
+ViewBounds contentBounds() {
+	ViewBounds bounds;
+	auto addWorld = [&](float x, float y) {
+		float screenX, screenY;
+		view.toScreen(x, y, screenX, screenY);
+		bounds.add(screenX, screenY);
+	};
+	for (size_t i = 0; i + 1 < controlPoints.size(); i += 2) {
+		addWorld(controlPoints[i], controlPoints[i + 1]);
+	}
+	for (size_t i = 0; capturing && i + 1 < strokeSamples.size(); i += 2) {
+		addWorld(strokeSamples[i], strokeSamples[i + 1]);
+	}
+	if (!gpuCurveActive()) {
+		for (size_t i = 0; i + 1 < curvePoints.size(); i += 2) {
+			addWorld(curvePoints[i], curvePoints[i + 1]);
+		}
+	}
+	if (bounds.empty()) return bounds;
+
+	// Point radius or how far strokes reach past the polylines (half the width,
+	// up to MITER_LIMIT times that at thick miter joins), plus a few pixels for anti-aliasing
+	float reachPixels = 0.5f * strokeWidth * (thickStrokes ? StrokeRenderer::reach(strokeJoin, strokeCap) : 1.0f);
+	float marginY = std::max(CONTROL_POINT_RADIUS, reachPixels * 2.0f / WINDOW_HEIGHT) + 4.0f * 2.0f / WINDOW_HEIGHT;
+	float marginX = marginY * WINDOW_HEIGHT / WINDOW_WIDTH;
+	bounds.minX -= marginX;
+	bounds.maxX += marginX;
+	bounds.minY -= marginY;
+	bounds.maxY += marginY;
+	return bounds;
+}
+
+// Restrict this frame to the damaged region, or to nothing when tracking is off
+void beginDamagedFrame() {
+	ViewBounds current = contentBounds();
+	if (!damageTracking || fullRedraws > 0) {
+		glDisable(GL_SCISSOR_TEST);
+		if (fullRedraws > 0) --fullRedraws;
+	}
+	else {
+		ViewBounds damage = current;
+		damage.add(drawnBounds[0]);
+		damage.add(drawnBounds[1]);
+
+		int width, height;
+		glfwGetFramebufferSize(window, &width, &height);
+		int x0 = 0, y0 = 0, x1 = 0, y1 = 0;
+		if (!damage.empty()) {
+			x0 = std::max(0, (int)std::floor((damage.minX + 1.0f) * 0.5f * width));
+			y0 = std::max(0, (int)std::floor((damage.minY + 1.0f) * 0.5f * height));
+			x1 = std::min(width, (int)std::ceil((damage.maxX + 1.0f) * 0.5f * width));
+			y1 = std::min(height, (int)std::ceil((damage.maxY + 1.0f) * 0.5f * height));
+		}
+		glEnable(GL_SCISSOR_TEST);
+		glScissor(x0, y0, std::max(0, x1 - x0), std::max(0, y1 - y0));
+	}
+	drawnBounds[1] = drawnBounds[0];
+	drawnBounds[0] = current;
+}
+
+void window_refresh_callback(GLFWwindow*) {
+	invalidateView();
+}
+
+// The camera moved: retessellate for the new zoom and visible area, redraw everything
+void viewChanged() {
+	requestRebuild();
+	invalidateView();
+
+	// Keep grid cells near the pick radius, so a pick looks at a few cells at any zoom
+	float radius = PICK_RADIUS / view.scale;
+	float cell = pointGrid.currentCellSize();
+	if (radius > 4.0f * cell || radius < 0.25f * cell) {
+		pointGrid.setCellSize(radius);
+	}
+}
+
+// Hand the camera to every program that draws world coordinates
+void applyView() {
+	glUseProgram(shaderProgram);
+	setViewUniform(shaderProgram, view);
+	glUseProgram(gpuCurveProgram);
+	setViewUniform(gpuCurveProgram, view);
+	pointRenderer.setView(view);
+	markerRenderer.setView(view);
+	sdfRenderer.setView(view);
+	strokeRenderer.setView(view);
+	fillRenderer.setView(view);
+}
+
+// Zoom about the cursor
+void scroll_callback(GLFWwindow*, double, double yoffset) {
+	double xpos, ypos;
+	glfwGetCursorPos(window, &xpos, &ypos);
+	float sx, sy;
+	cursorToScreen(xpos, ypos, sx, sy);
+	float factor = std::pow(1.2f, (float)yoffset);
+	factor = std::min(MAX_ZOOM, std::max(MIN_ZOOM, view.scale * factor)) / view.scale;
+	if (factor == 1.0f) return;
+	view.zoomAt(sx, sy, factor);
+	viewChanged();
+}
+
+// Report how many input events were folded into each curve update, once a second
+void reportEditCoalescing() {
+	++edits.frames;
+	auto now = std::chrono::steady_clock::now();
+	if (now - edits.lastReport < std::chrono::seconds(1)) return;
+	if (edits.events > 0) {
+		std::cout << "Edits: " << edits.events << " events -> " << edits.updates << " curve updates in "
+			<< edits.frames << " frames (" << edits.events - edits.updates << " coalesced)" << std::endl;
+	}
+	edits.events = edits.updates = edits.frames = 0;
+	edits.lastReport = now;
+}
+
+// Fit the captured stroke and make it the curve, as piecewise cubic Beziers
+// within FIT_TOLERANCE_PIXELS of every sample at the current zoom
+void finishStroke() {
+	capturing = false;
+	int samples = strokeSamples.size() / 2;
+	if (samples < 2) return;
+
+	float tolerance = FIT_TOLERANCE_PIXELS / std::max(pixelsPerUnitX(view), pixelsPerUnitY(view));
+	auto start = std::chrono::steady_clock::now();
+	strokeFitter.fit(strokeSamples.data(), samples, tolerance, controlPoints);
+	auto end = std::chrono::steady_clock::now();
+	if (controlPoints.size() < 4) {
+		// A click without movement: keep it as a single point
+		controlPoints.push_back(controlPoints[0]);
+		controlPoints.push_back(controlPoints[1]);
+	}
+	pointGrid.build(controlPoints.data(), controlPoints.size() / 2);
+	curveBasis = CurveBasis::PiecewiseBezier;
+	std::cout << "Freehand stroke: " << samples << " samples fitted with " << strokeFitter.lastSegments()
+		<< " cubic segments, " << controlPoints.size() / 2 << " control points, in "
+		<< std::chrono::duration<double, std::micro>(end - start).count() << " us" << std::endl;
+	strokeSamples.clear();
+	requestRebuild();
 }
 
 // Mouse handling
-void mouse_button_callback(GLFWwindow*, int button, int action, int) {
+void mouse_button_callback(GLFWwindow*, int button, int action, int mods) {
 	if (action == GLFW_PRESS) {
 		double xpos, ypos;
 		glfwGetCursorPos(window, &xpos, &ypos);
 		float mx, my;
 		screenToGLCoords(xpos, ypos, mx, my);
 
-		if (button == GLFW_MOUSE_BUTTON_LEFT) {
+		if (button == GLFW_MOUSE_BUTTON_MIDDLE) {
+			panning = true;
+			cursorToScreen(xpos, ypos, panX, panY);
+		}
+		else if (button == GLFW_MOUSE_BUTTON_LEFT) {
 			// Check if clicking on an existing point for dragging
 			int pointIndex = findPointUnderCursor(mx, my);
 			if (pointIndex != -1) {
@@ -175,48 +1063,338 @@ void mouse_button_callback(GLFWwindow*, int button, int action, int) {
 				return;
 			}
 
-			// Otherwise add a new point
+			// Shift-click on the curve inserts a point there, ready to drag
+			if (mods & GLFW_MOD_SHIFT) {
+				pointIndex = insertPointOnCurve(mx, my);
+				if (pointIndex != -1) {
+					dragging = true;
+					draggedIndex = pointIndex;
+					requestRebuild();
+					return;
+				}
+			}
+
+			// In freehand mode, start recording a stroke
+			if (freehand) {
+				capturing = true;
+				strokeSamples.assign({ mx, my });
+				strokeDirty = true;
+				needsRedraw = true;
+				return;
+			}
+
+			// Otherwise add a new point; a piecewise Bezier gets a straight
+			// segment to it, handles at the thirds
+			int count = controlPoints.size() / 2;
+			if (compositeAppendCount(curveBasis, count) == 3) {
+				float lastX = controlPoints[count * 2 - 2], lastY = controlPoints[count * 2 - 1];
+				for (int k = 1; k < 3; ++k) {
+					float hx = lastX + (mx - lastX) * k / 3.0f, hy = lastY + (my - lastY) * k / 3.0f;
+					controlPoints.push_back(hx);
+					controlPoints.push_back(hy);
+					pointGrid.insert(pointGrid.size(), hx, hy);
+				}
+			}
 			controlPoints.push_back(mx);
 			controlPoints.push_back(my);
-			updateBuffers();
+			pointGrid.insert(pointGrid.size(), mx, my);
+			requestRebuild();
 		}
 		else if (button == GLFW_MOUSE_BUTTON_RIGHT && !controlPoints.empty()) {
 			// Find if we're clicking on a specific point to delete
 			int pointIndex = findPointUnderCursor(mx, my);
 			if (pointIndex != -1) {
+				// A piecewise Bezier loses a whole segment's worth of points
+				int count = controlPoints.size() / 2;
+				int first;
+				int erased = compositeEraseRange(curveBasis, count, pointIndex, first);
 				// Only delete if we still have enough control points (at least 2)
-				if (controlPoints.size() > 4) { // Keep at least 2 points (4 floats)
-					controlPoints.erase(controlPoints.begin() + pointIndex * 2,
-						controlPoints.begin() + pointIndex * 2 + 2);
-					updateBuffers();
+				if (erased > 0 && count - erased >= 2) {
+					controlPoints.erase(controlPoints.begin() + first * 2,
+						controlPoints.begin() + (first + erased) * 2);
+					if (erased == 1) {
+						pointGrid.erase(pointIndex);
+					}
+					else {
+						pointGrid.build(controlPoints.data(), controlPoints.size() / 2);
+					}
+					requestRebuild();
 				}
 			}
 		}
 	}
+	else if (action == GLFW_RELEASE && button == GLFW_MOUSE_BUTTON_MIDDLE) {
+		panning = false;
+	}
+	else if (action == GLFW_RELEASE && button == GLFW_MOUSE_BUTTON_LEFT && capturing) {
+		finishStroke();
+	}
 	else if (action == GLFW_RELEASE) {
+		// Incremental patches accumulate rounding error; resync once the drag ends
+		if (dragging && incrementalDrag && curveBasis == CurveBasis::GlobalBezier && !gpuCurveActive()) {
+			requestRebuild();
+		}
 		dragging = false;
 		draggedIndex = -1;
 	}
 }
 
 void cursor_position_callback(GLFWwindow*, double xpos, double ypos) {
+	if (capturing) {
+		// Every event is kept; the fit does the compression
+		float mx, my;
+		screenToGLCoords(xpos, ypos, mx, my);
+		strokeSamples.push_back(mx);
+		strokeSamples.push_back(my);
+		strokeDirty = true;
+		needsRedraw = true;
+	}
+	if (panning) {
+		float sx, sy;
+		cursorToScreen(xpos, ypos, sx, sy);
+		view.pan(sx - panX, sy - panY);
+		panX = sx;
+		panY = sy;
+		viewChanged();
+	}
 	if (dragging && draggedIndex != -1) {
 		float mx, my;
 		screenToGLCoords(xpos, ypos, mx, my);
-		controlPoints[draggedIndex * 2] = mx;
-		controlPoints[draggedIndex * 2 + 1] = my;
-		updateBuffers();
+		if (snapping) {
+			int target = findPointUnderCursor(mx, my, PICK_RADIUS, draggedIndex);
+			if (target != -1) {
+				mx = controlPoints[target * 2];
+				my = controlPoints[target * 2 + 1];
+			}
+		}
+		edits.dragPending = true;
+		edits.dragIndex = draggedIndex;
+		edits.dragX = mx;
+		edits.dragY = my;
+		++edits.events;
+		needsRedraw = true;
 	}
 }
 
-int main() {
+void key_callback(GLFWwindow*, int key, int, int action, int) {
+	if (action != GLFW_PRESS) return;
+
+	if (key == GLFW_KEY_E) {
+		curveEngine = (CurveEngine)(((int)curveEngine + 1) % (int)CurveEngine::Count);
+		std::cout << "Curve engine: " << curveEngineName(curveEngine) << std::endl;
+		requestRebuild();
+		edits.reportAdaptive = curveEngine == CurveEngine::Adaptive;
+	}
+	else if (key == GLFW_KEY_P) {
+		applyPendingEdits();
+		compareCurveEngines();
+	}
+	else if (key == GLFW_KEY_B) {
+		curveBasis = (CurveBasis)(((int)curveBasis + 1) % (int)CurveBasis::Count);
+		std::cout << "Curve basis: " << curveBasisName(curveBasis) << std::endl;
+		requestRebuild();
+	}
+	else if (key == GLFW_KEY_G) {
+		gpuCurve = !gpuCurve;
+		std::cout << "GPU curve evaluation " << (gpuCurve ? "ON" : "OFF") << std::endl;
+		requestRebuild();
+	}
+	else if (key == GLFW_KEY_S) {
+		sdfCurve = !sdfCurve;
+		std::cout << "Distance-field curve " << (sdfCurve ? "ON" : "OFF") << std::endl;
+		requestRebuild();
+	}
+	else if (key == GLFW_KEY_F) {
+		fillShape = !fillShape;
+		std::cout << "Filled shape " << (fillShape ? "ON" : "OFF") << std::endl;
+		requestRebuild();
+	}
+	else if (key == GLFW_KEY_T) {
+		thickStrokes = !thickStrokes;
+		std::cout << "Thick strokes " << (thickStrokes ? "ON" : "OFF") << std::endl;
+		invalidateView();
+	}
+	else if (key == GLFW_KEY_J) {
+		strokeJoin = (StrokeJoin)(((int)strokeJoin + 1) % (int)StrokeJoin::Count);
+		std::cout << "Stroke join: " << strokeJoinName(strokeJoin) << std::endl;
+		invalidateView();
+	}
+	else if (key == GLFW_KEY_C) {
+		strokeCap = (StrokeCap)(((int)strokeCap + 1) % (int)StrokeCap::Count);
+		std::cout << "Stroke cap: " << strokeCapName(strokeCap) << std::endl;
+		invalidateView();
+	}
+	else if (key == GLFW_KEY_EQUAL || key == GLFW_KEY_MINUS) {
+		// Only a uniform changes; nothing is retessellated or uploaded
+		strokeWidth *= key == GLFW_KEY_EQUAL ? 1.25f : 0.8f;
+		strokeWidth = std::min(MAX_STROKE_WIDTH, std::max(MIN_STROKE_WIDTH, strokeWidth));
+		std::cout << "Stroke width: " << strokeWidth << " px" << std::endl;
+		invalidateView();
+	}
+	else if (key == GLFW_KEY_D) {
+		damageTracking = !damageTracking;
+		std::cout << "Damage tracking " << (damageTracking ? "ON" : "OFF") << std::endl;
+		invalidateView();
+	}
+	else if (key == GLFW_KEY_HOME) {
+		view = ViewTransform();
+		std::cout << "View reset" << std::endl;
+		viewChanged();
+	}
+	else if (key == GLFW_KEY_I) {
+		incrementalDrag = !incrementalDrag;
+		std::cout << "Incremental drag " << (incrementalDrag ? "ON" : "OFF") << std::endl;
+	}
+	else if (key == GLFW_KEY_N) {
+		snapping = !snapping;
+		std::cout << "Snap to points " << (snapping ? "ON" : "OFF") << std::endl;
+	}
+	else if (key == GLFW_KEY_X) {
+		showIntersections = !showIntersections;
+		std::cout << "Self-intersection markers " << (showIntersections ? "ON" : "OFF") << std::endl;
+		applyPendingEdits();
+		updateIntersections(true);
+		invalidateView();
+	}
+	else if (key == GLFW_KEY_H) {
+		freehand = !freehand;
+		std::cout << "Freehand strokes " << (freehand ? "ON" : "OFF") << std::endl;
+	}
+	else if (key == GLFW_KEY_A) {
+		asyncRebuild = !asyncRebuild;
+		std::cout << "Background curve rebuilds " << (asyncRebuild ? "ON" : "OFF")
+			<< " (" << curveWorker.cancelledJobs() << " stale jobs cancelled so far)" << std::endl;
+	}
+}
+
+// Draw one frame of curveVertexShaderSource into the window, read it back and
+// compare it with the CPU tessellation at the same parameters: every lit pixel
+// must lie near the CPU polyline and every CPU sample must have lit pixels
+// next to it. Runs a few curves and views; returns the process exit code.
+int runGpuCurveSelfTest() {
+	const float MAX_DISTANCE_PIXELS = 1.5f;
+	int width, height;
+	glfwGetFramebufferSize(window, &width, &height);
+	std::vector<unsigned char> pixels(4 * width * height);
+
+	struct SelfTestCase {
+		const char* name;
+		std::vector<GLfloat> points;
+		float zoom;
+	};
+	std::vector<SelfTestCase> cases = {
+		{ "cubic", controlPoints, 1.0f },
+		{ "degree 11", {}, 1.0f },
+		{ "degree 63", {}, 1.0f },
+		{ "cubic, zoomed 4x", controlPoints, 4.0f },
+	};
+	// Zigzags, up to the most points the shader takes
+	for (int k = 1; k <= 2; ++k) {
+		int count = k == 1 ? 12 : MAX_GPU_CONTROL_POINTS;
+		for (int i = 0; i < count; ++i) {
+			float t = i / (float)(count - 1);
+			cases[k].points.push_back(1.6f * t - 0.8f);
+			cases[k].points.push_back((i % 2 ? 0.9f : -0.9f) * (1.0f - t * 0.5f));
+		}
+	}
+
+	bool passed = true;
+	for (const SelfTestCase& test : cases) {
+		controlPoints = test.points;
+		view = ViewTransform();
+		view.zoomAt(0.25f, 0.1f, test.zoom);
+		uploadGpuCurve();
+		setViewUniform(gpuCurveProgram, view);
+
+		glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+		glClear(GL_COLOR_BUFFER_BIT);
+		glUniform3f(glGetUniformLocation(gpuCurveProgram, "uColor"), 0.0f, 1.0f, 0.0f);
+		glBindVertexArray(gpuCurveVAO);
+		glDrawArrays(GL_LINE_STRIP, 0, curveResolution + 1);
+		glPixelStorei(GL_PACK_ALIGNMENT, 1);
+		glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+
+		// The CPU samples in window pixels, bottom row first like glReadPixels
+		std::vector<GLfloat> reference = computeBezierCurve(controlPoints, curveResolution);
+		for (size_t i = 0; i + 1 < reference.size(); i += 2) {
+			float sx, sy;
+			view.toScreen(reference[i], reference[i + 1], sx, sy);
+			reference[i] = (sx + 1.0f) * 0.5f * width;
+			reference[i + 1] = (sy + 1.0f) * 0.5f * height;
+		}
+		auto lit = [&](int x, int y) {
+			return x >= 0 && y >= 0 && x < width && y < height && pixels[4 * (y * width + x) + 1] > 127;
+		};
+
+		int litPixels = 0;
+		float maxDistance = 0.0f;
+		for (int y = 0; y < height; ++y) {
+			for (int x = 0; x < width; ++x) {
+				if (!lit(x, y)) continue;
+				++litPixels;
+				float px = x + 0.5f, py = y + 0.5f;
+				float nearest = 1e30f;
+				for (size_t i = 0; i + 3 < reference.size(); i += 2) {
+					float ax = reference[i], ay = reference[i + 1];
+					float dx = reference[i + 2] - ax, dy = reference[i + 3] - ay;
+					float lengthSq = dx * dx + dy * dy;
+					float t = lengthSq > 0.0f ? ((px - ax) * dx + (py - ay) * dy) / lengthSq : 0.0f;
+					t = std::min(1.0f, std::max(0.0f, t));
+					float ex = ax + t * dx - px, ey = ay + t * dy - py;
+					nearest = std::min(nearest, ex * ex + ey * ey);
+				}
+				maxDistance = std::max(maxDistance, std::sqrt(nearest));
+			}
+		}
+
+		// Samples off screen are not drawn, so only visible ones must be covered
+		int uncovered = 0, visible = 0;
+		for (size_t i = 0; i + 1 < reference.size(); i += 2) {
+			int cx = (int)std::floor(reference[i]), cy = (int)std::floor(reference[i + 1]);
+			if (cx < 2 || cy < 2 || cx >= width - 2 || cy >= height - 2) continue;
+			++visible;
+			bool covered = false;
+			for (int y = cy - 1; y <= cy + 1 && !covered; ++y) {
+				for (int x = cx - 1; x <= cx + 1 && !covered; ++x) {
+					covered = lit(x, y);
+				}
+			}
+			if (!covered) ++uncovered;
+		}
+
+		bool ok = litPixels > 0 && maxDistance <= MAX_DISTANCE_PIXELS && uncovered == 0;
+		passed = passed && ok;
+		std::cout << "GPU curve self-test, " << test.name << ": " << curveResolution + 1 << " samples, " << litPixels
+			<< " pixels, max distance " << maxDistance << " px, " << uncovered << " of " << visible
+			<< " samples uncovered: " << (ok ? "ok" : "FAILED") << std::endl;
+	}
+	std::cout << "Renderer: " << glGetString(GL_RENDERER) << std::endl;
+	return passed ? 0 : 1;
+}
+
+int main(int argc, char** argv) {
+	// --gpu-curve starts in GPU evaluation mode. --selftest checks that mode
+	// without a visible window and exits, e.g. under Mesa's llvmpipe with
+	// LIBGL_ALWAYS_SOFTWARE=1 (and xvfb-run where there is no display).
+	bool selfTest = false;
+	for (int i = 1; i < argc; ++i) {
+		if (std::string(argv[i]) == "--gpu-curve") {
+			gpuCurve = true;
+		}
+		else if (std::string(argv[i]) == "--selftest") {
+			selfTest = true;
+		}
+	}
+
 	// Initialize GLFW
 	if (!glfwInit()) {
 		std::cerr << "Failed to initialize GLFW" << std::endl;
 		return -1;
 	}
 
-	// Create window
+	// Create window; the filled shape needs a stencil buffer
+	glfwWindowHint(GLFW_STENCIL_BITS, 8);
+	if (selfTest) glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
 	window = glfwCreateWindow(WINDOW_WIDTH, WINDOW_HEIGHT, "Bezier Curve Editor", nullptr, nullptr);
 	if (!window) {
 		std::cerr << "Failed to create window" << std::endl;
@@ -233,43 +1411,30 @@ int main() {
 		return -1;
 	}
 
+	// Finished background rebuilds wake the loop out of glfwWaitEvents
+	curveWorker.setReadyCallback([] { glfwPostEmptyEvent(); });
+
 	// Set callbacks
 	glfwSetMouseButtonCallback(window, mouse_button_callback);
 	glfwSetCursorPosCallback(window, cursor_position_callback);
+	glfwSetKeyCallback(window, key_callback);
+	glfwSetWindowRefreshCallback(window, window_refresh_callback);
+	glfwSetScrollCallback(window, scroll_callback);
 
-	// Compile shaders
-	GLuint vs = compileShader(GL_VERTEX_SHADER, vertexShaderSource);
-	GLuint fs = compileShader(GL_FRAGMENT_SHADER, fragmentShaderSource);
-
-	// Create and link shader program
-	shaderProgram = glCreateProgram();
-	glAttachShader(shaderProgram, vs);
-	glAttachShader(shaderProgram, fs);
-	glLinkProgram(shaderProgram);
-
-	// Check for linking errors
-	GLint success;
-	GLchar infoLog[512];
-	glGetProgramiv(shaderProgram, GL_LINK_STATUS, &success);
-	if (!success) {
-		glGetProgramInfoLog(shaderProgram, 512, NULL, infoLog);
-		std::cerr << "Shader program linking error: " << infoLog << std::endl;
-	}
+	// Compile and link shader programs
+	shaderProgram = createProgram(vertexShaderSource, fragmentShaderSource);
+	gpuCurveProgram = createProgram(curveVertexShaderSource, fragmentShaderSource);
 
-	// Delete shaders as they're linked into our program
-	glDeleteShader(vs);
-	glDeleteShader(fs);
+	// The GPU curve has no vertex attributes, but core profiles still need a bound VAO
+	glGenVertexArrays(1, &gpuCurveVAO);
 
-	// Create VAOs and VBOs
-	glGenVertexArrays(3, vao);
-	glGenBuffers(3, vbo);
-
-	for (int i = 0; i < 3; ++i) {
-		glBindVertexArray(vao[i]);
-		glBindBuffer(GL_ARRAY_BUFFER, vbo[i]);
-		glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), nullptr);
-		glEnableVertexAttribArray(0);
-	}
+	// Control points and curve samples share one streaming buffer; the control
+	// polygon and the point instances both read the same block
+	streamBuffer.init();
+	glGenVertexArrays(1, &lineVAO);
+	glBindVertexArray(lineVAO);
+	glEnableVertexAttribArray(0);
+	glBindVertexArray(0);
 
 	// Initial control points
 	controlPoints = {
@@ -278,57 +1443,164 @@ int main() {
 		0.4f, -0.9f,
 		0.8f,  0.8f
 	};
-	updateBuffers();
+	pointGrid.build(controlPoints.data(), controlPoints.size() / 2);
+	edits.rebuild = true;
+
+	if (selfTest) {
+		gpuCurve = true;
+		int status = runGpuCurveSelfTest();
+		streamBuffer.destroy();
+		glDeleteVertexArrays(1, &lineVAO);
+		glDeleteVertexArrays(1, &gpuCurveVAO);
+		glDeleteProgram(shaderProgram);
+		glDeleteProgram(gpuCurveProgram);
+		glfwTerminate();
+		return status;
+	}
+
+	// Print instructions
+	std::cout << "Controls:" << std::endl;
+	std::cout << "  Left click  - Add / drag control point" << std::endl;
+	std::cout << "  Right click - Delete control point" << std::endl;
+	std::cout << "  Shift + left click on the curve - Insert control point there" << std::endl;
+	std::cout << "  Scroll - Zoom about the cursor, middle drag - Pan, Home - Reset view" << std::endl;
+	std::cout << "  E - Cycle curve engine" << std::endl;
+	std::cout << "  B - Cycle curve basis (global Bezier, B-spline, Catmull-Rom, piecewise Bezier)" << std::endl;
+	std::cout << "  P - Compare curve engines" << std::endl;
+	std::cout << "  I - Toggle incremental drag updates" << std::endl;
+	std::cout << "  A - Toggle background curve rebuilds" << std::endl;
+	std::cout << "  N - Toggle snapping dragged points onto other points" << std::endl;
+	std::cout << "  X - Toggle self-intersection markers" << std::endl;
+	std::cout << "  H - Toggle freehand strokes (drag over empty space, fitted with cubic Beziers)" << std::endl;
+	std::cout << "  S - Toggle anti-aliased distance-field curve strokes" << std::endl;
+	std::cout << "  F - Toggle filled shape (closed by the chord back to the first point)" << std::endl;
+	std::cout << "  T - Toggle thick strokes (J - cycle joins, C - cycle caps)" << std::endl;
+	std::cout << "  +/- - Change stroke width" << std::endl;
+	std::cout << "  D - Toggle scissored redraws of the damaged region" << std::endl;
+	std::cout << "  G - Toggle GPU curve evaluation (up to " << MAX_GPU_CONTROL_POINTS << " points)" << std::endl;
 
-	// Create a VAO for circle rendering
-	GLuint circleVAO;
-	glGenVertexArrays(1, &circleVAO);
+	// Control points are drawn instanced straight from the streamed point block
+	pointRenderer.init();
+	markerRenderer.init();
+	sdfRenderer.init();
+	strokeRenderer.init();
+	fillRenderer.init();
 
 	// Enable blending for nicer looking circles
 	glEnable(GL_BLEND);
 	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-	// Main loop
+	// Main loop: redraw only when an edit, a setting or the window asks for it
 	while (!glfwWindowShouldClose(window)) {
+		// A curve finished on the worker is a reason to redraw too
+		collectCurveResult();
+		if (!needsRedraw) {
+			glfwWaitEvents();
+			continue;
+		}
+		needsRedraw = false;
+
+		applyPendingEdits();
+		reportEditCoalescing();
+		beginDamagedFrame();
+
 		// Clear the screen
 		glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
-		glClear(GL_COLOR_BUFFER_BIT);
+		glClear(GL_COLOR_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+
+		streamBuffer.beginFrame();
+		streamVertexData();
+
+		int width, height;
+		glfwGetFramebufferSize(window, &width, &height);
+		applyView();
+		int firstPoint = pointAllocation.offset / (2 * sizeof(float));
+		int firstCurvePoint = curveAllocation.offset / (2 * sizeof(float));
+
+		// Translucent fill underneath the outlines
+		if (fillShape) {
+			fillRenderer.draw(streamBuffer.buffer(), fillAllocation.offset, fillTriangles.size() / FILL_VERTEX_FLOATS,
+				0.0f, 1.0f, 0.0f, 0.3f);
+		}
 
 		// Use shader program
 		glUseProgram(shaderProgram);
 
 		// Draw blue lines for control polygon
-		glUniform3f(glGetUniformLocation(shaderProgram, "uColor"), 0.0f, 0.0f, 1.0f);
-		glBindVertexArray(vao[1]);
-		glLineWidth(1.5f);
-		glDrawArrays(GL_LINE_STRIP, 0, controlPoints.size() / 2);
+		if (thickStrokes) {
+			strokeRenderer.draw(streamBuffer.buffer(), firstPoint, controlPoints.size() / 2, 0.75f * strokeWidth,
+				strokeJoin, strokeCap, width, height, 0.0f, 0.0f, 1.0f);
+			glUseProgram(shaderProgram);
+		}
+		else {
+			glUniform3f(glGetUniformLocation(shaderProgram, "uColor"), 0.0f, 0.0f, 1.0f);
+			glLineWidth(1.5f);
+			drawStreamed(GL_LINE_STRIP, pointAllocation, controlPoints.size() / 2);
+		}
 
 		// Draw green curve
-		glUniform3f(glGetUniformLocation(shaderProgram, "uColor"), 0.0f, 1.0f, 0.0f);
-		glBindVertexArray(vao[2]);
 		glLineWidth(2.0f);
-		glDrawArrays(GL_LINE_STRIP, 0, curvePoints.size() / 2);
+		if (sdfCurve) {
+			sdfRenderer.drawInstances(streamBuffer.buffer(), quadraticAllocation.offset, curveQuadratics.quadraticCount(),
+				strokeWidth, width, height, 0.0f, 1.0f, 0.0f);
+			glUseProgram(shaderProgram);
+		}
+		else if (gpuCurveActive()) {
+			glUseProgram(gpuCurveProgram);
+			glUniform3f(glGetUniformLocation(gpuCurveProgram, "uColor"), 0.0f, 1.0f, 0.0f);
+			glBindVertexArray(gpuCurveVAO);
+			glDrawArrays(GL_LINE_STRIP, 0, curveResolution + 1);
+			glUseProgram(shaderProgram);
+		}
+		else if (thickStrokes) {
+			strokeRenderer.draw(streamBuffer.buffer(), firstCurvePoint, curvePoints.size() / 2, strokeWidth,
+				strokeJoin, strokeCap, width, height, 0.0f, 1.0f, 0.0f);
+			glUseProgram(shaderProgram);
+		}
+		else {
+			glUniform3f(glGetUniformLocation(shaderProgram, "uColor"), 0.0f, 1.0f, 0.0f);
+			drawStreamed(GL_LINE_STRIP, curveAllocation, curvePoints.size() / 2);
+		}
+
+		// The stroke being captured, raw
+		if (capturing) {
+			glUseProgram(shaderProgram);
+			glUniform3f(glGetUniformLocation(shaderProgram, "uColor"), 1.0f, 1.0f, 1.0f);
+			glLineWidth(1.0f);
+			drawStreamed(GL_LINE_STRIP, strokeAllocation, strokeSamples.size() / 2);
+		}
 
-		// Draw red control points as perfect circles
-		glUniform3f(glGetUniformLocation(shaderProgram, "uColor"), 1.0f, 0.0f, 0.0f);
-		glBindVertexArray(circleVAO);
+		// Draw red control points as circles, one instanced call
+		if (pointAllocation.valid) {
+			pointRenderer.drawInstances(streamBuffer.buffer(), pointAllocation.offset, controlPoints.size() / 2,
+				CONTROL_POINT_RADIUS, (float)WINDOW_WIDTH / WINDOW_HEIGHT, 1.0f, 0.0f, 0.0f);
+		}
 
-		for (int i = 0; i < controlPoints.size() / 2; ++i) {
-			float x = controlPoints[i * 2];
-			float y = controlPoints[i * 2 + 1];
-			drawCircle(x, y, 0.015f);
+		// Yellow self-intersection markers on top
+		if (showIntersections) {
+			updateIntersections(false);
+			markerRenderer.draw(0.6f * CONTROL_POINT_RADIUS, (float)WINDOW_WIDTH / WINDOW_HEIGHT, 1.0f, 1.0f, 0.0f);
 		}
+		streamBuffer.endFrame();
 
 		// Swap buffers and poll events
 		glfwSwapBuffers(window);
 		glfwPollEvents();
 	}
 
-	// Cleanup
-	glDeleteVertexArrays(3, vao);
-	glDeleteBuffers(3, vbo);
-	glDeleteVertexArrays(1, &circleVAO);
+	// Cleanup; the worker must not post events after glfwTerminate
+	curveWorker.wait();
+	curveWorker.setReadyCallback(nullptr);
+	glDeleteVertexArrays(1, &lineVAO);
+	streamBuffer.destroy();
+	pointRenderer.destroy();
+	markerRenderer.destroy();
+	sdfRenderer.destroy();
+	strokeRenderer.destroy();
+	fillRenderer.destroy();
+	glDeleteVertexArrays(1, &gpuCurveVAO);
 	glDeleteProgram(shaderProgram);
+	glDeleteProgram(gpuCurveProgram);
 
 	glfwTerminate();
 	return 0;
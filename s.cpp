@@ -1,21 +1,20 @@
 if (!control_points.empty()) {
-    glColor3f(CONTROL_POINT.r, CONTROL_POINT.g, CONTROL_POINT.b);
     const float radius = 0.02f; // Adjust radius to your scale
-    const int segments = 20;    // Number of triangle segments for the circle
 
-    for (auto it = control_points.begin(); it != control_points.end(); ++it) {
-        Point p = (is_moving && it == move_iter && !moving_points.empty())
-            ? moving_points.back() : *it;
-        Point gl_p = screen_to_gl(p);
-
-        glBegin(GL_TRIANGLE_FAN);
-        glVertex2f(gl_p.x, gl_p.y); // Center of circle
-        for (int i = 0; i <= segments; ++i) {
-            float angle = i * 2.0f * M_PI / segments;
-            float dx = cosf(angle) * radius;
-            float dy = sinf(angle) * radius;
-            glVertex2f(gl_p.x + dx, gl_p.y + dy);
+    // Re-upload the instance centers only when a point was added, moved or removed
+    if (control_points_dirty) {
+        point_centers.clear();
+        for (auto it = control_points.begin(); it != control_points.end(); ++it) {
+            Point p = (is_moving && it == move_iter && !moving_points.empty())
+                ? moving_points.back() : *it;
+            Point gl_p = screen_to_gl(p);
+            point_centers.push_back(gl_p.x);
+            point_centers.push_back(gl_p.y);
         }
-        glEnd();
+        point_renderer.setPoints(point_centers.data(), point_centers.size() / 2);
+        control_points_dirty = false;
     }
+
+    // One instanced draw for every control point
+    point_renderer.draw(radius, 1.0f, CONTROL_POINT.r, CONTROL_POINT.g, CONTROL_POINT.b);
 }
@@ -0,0 +1,167 @@
+#pragma once
+
+#include <GL/glew.h>
+#include "shader_utils.h"
+#include "view_transform.h"
+#include "bezier_quadratic.h"
+
+// Distance-field stroke renderer for chains of quadratic Bezier pieces.
+//
+// Each piece is one instance: the vertex shader covers the bounding box of
+// its control triangle, grown by the half width, and the fragment shader
+// solves for the closest point on the quadratic in closed form (the cubic
+// from Inigo Quilez's sdBezier, polished with two Newton steps). Coverage is
+// the distance in pixels, so strokes of any width come out anti-aliased
+// without dense tessellation or MSAA. Where two pieces meet, fragments whose
+// closest point is a piece's start are left to the previous piece, so joints
+// are not blended twice.
+class SdfCurveRenderer {
+public:
+    void init() {
+        program = createProgram(vertexSource, fragmentSource);
+        glGenVertexArrays(1, &vao);
+        glBindVertexArray(vao);
+        for (int i = 0; i < 3; ++i) {
+            glVertexAttribDivisor(i, 1);
+            glEnableVertexAttribArray(i);
+        }
+        glBindVertexArray(0);
+    }
+
+    void destroy() {
+        glDeleteVertexArrays(1, &vao);
+        glDeleteProgram(program);
+    }
+
+    // World-to-screen mapping applied to every point; identity by default
+    void setView(const ViewTransform& transform) {
+        view = transform;
+    }
+
+    // Draw count pieces (QUADRATIC_FLOATS floats each, GL coordinates) stored at offset in buffer
+    void drawInstances(GLuint buffer, GLintptr offset, int count, float width, int viewportWidth, int viewportHeight,
+        float r, float g, float b) {
+        if (count <= 0) return;
+        glUseProgram(program);
+        glUniform2f(glGetUniformLocation(program, "uViewport"), (float)viewportWidth, (float)viewportHeight);
+        setViewUniform(program, view);
+        glUniform1f(glGetUniformLocation(program, "uHalfWidth"), 0.5f * width);
+        glUniform3f(glGetUniformLocation(program, "uColor"), r, g, b);
+
+        glBindVertexArray(vao);
+        glBindBuffer(GL_ARRAY_BUFFER, buffer);
+        for (int i = 0; i < 3; ++i) {
+            glVertexAttribPointer(i, 2, GL_FLOAT, GL_FALSE, QUADRATIC_FLOATS * sizeof(float),
+                (const void*)(offset + i * 2 * sizeof(float)));
+        }
+        glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, count);
+        glBindVertexArray(0);
+    }
+
+private:
+    GLuint program = 0;
+    GLuint vao = 0;
+    ViewTransform view;
+
+    const char* vertexSource = R"(
+#version 330 core
+layout (location = 0) in vec2 start;
+layout (location = 1) in vec2 control;
+layout (location = 2) in vec2 end;
+uniform vec2 uViewport;
+uniform vec4 uView;
+uniform float uHalfWidth;
+flat out vec2 A;
+flat out vec2 B;
+flat out vec2 C;
+flat out int firstPiece;
+void main() {
+    // Work in window pixels so distances and widths are in pixels
+    A = ((start * uView.xy + uView.zw) * 0.5 + 0.5) * uViewport;
+    B = ((control * uView.xy + uView.zw) * 0.5 + 0.5) * uViewport;
+    C = ((end * uView.xy + uView.zw) * 0.5 + 0.5) * uViewport;
+    firstPiece = gl_InstanceID == 0 ? 1 : 0;
+
+    vec2 margin = vec2(uHalfWidth + 1.0);
+    vec2 lo = min(min(A, B), C) - margin;
+    vec2 hi = max(max(A, B), C) + margin;
+    vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+    gl_Position = vec4(mix(lo, hi, corner) / uViewport * 2.0 - 1.0, 0.0, 1.0);
+}
+)";
+
+    const char* fragmentSource = R"(
+#version 330 core
+flat in vec2 A;
+flat in vec2 B;
+flat in vec2 C;
+flat in int firstPiece;
+uniform float uHalfWidth;
+uniform vec3 uColor;
+out vec4 FragColor;
+
+// Q(t) - pos = d + 2at + bt^2
+float distanceSq(vec2 d, vec2 a, vec2 b, float t) {
+    vec2 q = d + (2.0 * a + b * t) * t;
+    return dot(q, q);
+}
+
+// Newton steps on dot(Q(t) - pos, Q'(t)) = 0 to remove float cancellation
+float polish(vec2 d, vec2 a, vec2 b, float t) {
+    for (int i = 0; i < 2; ++i) {
+        vec2 q = d + (2.0 * a + b * t) * t;
+        vec2 dq = 2.0 * (a + b * t);
+        float df = dot(dq, dq) + 2.0 * dot(q, b);
+        if (df > 0.0) t = clamp(t - dot(q, dq) / df, 0.0, 1.0);
+    }
+    return t;
+}
+
+// Parameter of the closest point on the quadratic A, B, C
+float closestParameter(vec2 pos) {
+    vec2 a = B - A;
+    vec2 b = A - 2.0 * B + C;
+    vec2 d = A - pos;
+    float bb = dot(b, b);
+    if (bb <= 1e-4 * dot(a, a)) {
+        // Nearly straight (or a single point, bb == 0): the cubic is ill-conditioned, start from the chord
+        vec2 e = C - A;
+        return polish(d, a, b, clamp(-dot(d, e) / max(dot(e, e), 1e-12), 0.0, 1.0));
+    }
+
+    float kk = 1.0 / bb;
+    float kx = kk * dot(a, b);
+    float ky = kk * (2.0 * dot(a, a) + dot(d, b)) / 3.0;
+    float kz = kk * dot(d, a);
+    float p = ky - kx * kx;
+    float q = kx * (2.0 * kx * kx - 3.0 * ky) + kz;
+    float h = q * q + 4.0 * p * p * p;
+    if (h >= 0.0) {
+        h = sqrt(h);
+        vec2 x = (vec2(h, -h) - q) / 2.0;
+        vec2 uv = sign(x) * pow(abs(x), vec2(1.0 / 3.0));
+        return polish(d, a, b, clamp(uv.x + uv.y - kx, 0.0, 1.0));
+    }
+    // Three real roots; the middle one is never the closest
+    float z = sqrt(-p);
+    float v = acos(q / (p * z * 2.0)) / 3.0;
+    float m = cos(v);
+    float n = sin(v) * 1.732050808;
+    float t0 = polish(d, a, b, clamp((m + m) * z - kx, 0.0, 1.0));
+    float t1 = polish(d, a, b, clamp((-n - m) * z - kx, 0.0, 1.0));
+    return distanceSq(d, a, b, t0) < distanceSq(d, a, b, t1) ? t0 : t1;
+}
+
+void main() {
+    vec2 pos = gl_FragCoord.xy;
+    float t = closestParameter(pos);
+    // The previous piece's end cap already covers this joint
+    if (t <= 0.0 && firstPiece == 0) discard;
+
+    float dist = sqrt(distanceSq(A - pos, B - A, A - 2.0 * B + C, t));
+    float alpha = clamp(uHalfWidth + 0.5 - dist, 0.0, 1.0);
+    if (alpha <= 0.0) discard;
+    FragColor = vec4(uColor, alpha);
+}
+)";
+};
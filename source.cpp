@@ -1,11 +1,38 @@
+#include <GL/glew.h>
 #include <GLFW/glfw3.h>
 #include <vector>
 #include <cmath>
+#include <iostream>
+#include <algorithm>
+#include "bezier_simd.h"
+#include "bernstein_cache.h"
+#include "bezier_adaptive.h"
+#include "parallel_tessellate.h"
+#include "composite_curve.h"
+#include "bezier_templates.h"
+#include "shader_utils.h"
+#include "point_renderer.h"
+#include "async_tessellator.h"
+#include "point_grid.h"
+#include "arc_length.h"
+#include "view_transform.h"
+#include "bezier_bounds.h"
 
 constexpr float WIDTH = 900.0f;
 constexpr float HEIGHT = 600.0f;
 constexpr float POINT_THRESHOLD = 10.0f;
-constexpr float CURVE_STEP = 0.0001f;
+constexpr int MIN_CURVE_STEPS = 64;
+constexpr int MAX_CURVE_STEPS = 1 << 17;
+constexpr float CURVE_POINT_SPACING = 2.0f; // on-screen pixels between plotted curve samples, at most
+constexpr float CURVE_TOLERANCE = 0.25f; // in pixels
+constexpr int MIN_SEGMENT_RESOLUTION = 4;  // per composite segment
+constexpr int MAX_SEGMENT_RESOLUTION = 1024;
+constexpr float CONTROL_POINT_SIZE = 15.0f; // diameter in pixels
+constexpr float MIN_ZOOM = 1.0f / 16.0f;
+constexpr float MAX_ZOOM = 64.0f;
+
+// Set by every input callback; the main loop sleeps in glfwWaitEvents otherwise
+bool needs_redraw = true;
 
 // Struct for RGB color
 struct Color {
@@ -29,6 +56,56 @@ struct Point {
     Point operator+(const Point& p) const { return { x + p.x, y + p.y }; }
 };
 
+// Points are handed to the shared curve kernels as interleaved x/y floats
+static_assert(sizeof(Point) == 2 * sizeof(float), "Point must be two packed floats");
+
+inline float* point_floats(std::vector<Point>& points) { return &points[0].x; }
+inline const float* point_floats(const std::vector<Point>& points) { return &points[0].x; }
+
+// Flat-colored positions in GL coordinates, through the pan/zoom view
+const char* VERTEX_SHADER = R"(
+#version 330 core
+layout (location = 0) in vec2 position;
+uniform vec4 uView;
+void main() {
+    gl_Position = vec4(position * uView.xy + uView.zw, 0.0, 1.0);
+}
+)";
+
+const char* FRAGMENT_SHADER = R"(
+#version 330 core
+uniform vec3 uColor;
+out vec4 FragColor;
+void main() {
+    FragColor = vec4(uColor, 1.0);
+}
+)";
+
+// Curve evaluation engines, cycled with the E key
+enum class CurveEngine {
+    DeCasteljau,
+    Simd,
+    BernsteinMatrix,
+    Adaptive,
+    Parallel,
+    Specialized,
+    ArcLength,
+    Count
+};
+
+inline const char* curve_engine_name(CurveEngine engine) {
+    switch (engine) {
+    case CurveEngine::DeCasteljau: return "De Casteljau";
+    case CurveEngine::Simd: return "SIMD De Casteljau (" BEZIER_SIMD_NAME ")";
+    case CurveEngine::BernsteinMatrix: return "Cached Bernstein matrix";
+    case CurveEngine::Adaptive: return "Adaptive subdivision";
+    case CurveEngine::Parallel: return "Parallel SIMD De Casteljau";
+    case CurveEngine::Specialized: return "Degree-specialized templates";
+    case CurveEngine::ArcLength: return "Arc-length spacing";
+    default: return "Unknown";
+    }
+}
+
 class BezierCurve {
 private:
     std::vector<Point> control_points;
@@ -37,6 +114,47 @@ private:
     std::vector<Point>::iterator move_iter;
     bool is_moving = false;
     bool is_deleting = false;
+    CurveEngine engine = CurveEngine::Parallel;
+    SimdBezierEvaluator simd_evaluator;
+    AdaptiveTessellator adaptive_tessellator;
+    std::vector<float> adaptive_points;
+    ArcLengthTable arc_length_table;
+    std::vector<float> arc_length_points;
+    ParallelTessellator parallel_tessellator;
+    std::vector<float> dispatch_scratch;
+    CurveBasis basis = CurveBasis::GlobalBezier;
+    CompositeCurve composite;
+    bool report_curve = false; // print the vertex count of the next curve collected (E key)
+
+    // Picking index over control_points, in canvas pixels; edited alongside it
+    PointGrid point_grid{ POINT_THRESHOLD };
+    bool snapping = false; // released points land on a nearby point (N key)
+
+    // Pan/zoom camera over the canvas: points stay in canvas pixels (window
+    // pixels at the default view) and the view is applied in the shaders.
+    // Scroll zooms about the cursor, middle drag pans, Home resets.
+    ViewTransform view;
+    bool is_panning = false;
+    Point pan_anchor; // GL coordinates of the cursor at the last pan step
+
+    // Retained GPU copies; curve_gl_points is refreshed only when the curve changes
+    GLuint program = 0;
+    GLuint vao = 0;
+    GLuint curve_buffer = 0;
+    GLuint control_buffer = 0;
+    std::vector<Point> curve_gl_points;
+    std::vector<float> point_centers;
+    ControlPointRenderer point_renderer;
+    size_t curve_capacity = 0;
+    int curve_dirty_first = 0;
+    int curve_dirty_last = -1;
+    bool control_points_dirty = true;
+
+    // Curves are recomputed on a worker thread from a snapshot of the control
+    // points; the engines above are the worker's while it is busy. Declared
+    // last so the thread stops before anything it uses is destroyed.
+    std::vector<Point> finished_points;
+    AsyncTessellator<std::vector<Point>> tessellator;
 
     // Convert screen to OpenGL coordinates
     static Point screen_to_gl(Point p) {
@@ -46,137 +164,439 @@ private:
         };
     }
 
-    // Check if points are close enough
-    static bool is_close(Point p1, Point p2) {
-        return std::sqrt(std::pow(p1.x - p2.x, 2) +
-            std::pow(p1.y - p2.y, 2)) <= POINT_THRESHOLD;
+    static Point gl_to_screen(Point p) {
+        return { (p.x + 1) * WIDTH / 2, (1 - p.y) * HEIGHT / 2 };
+    }
+
+    // Window pixels to canvas pixels through the current view
+    Point window_to_canvas(Point p) const {
+        Point gl = screen_to_gl(p);
+        Point world;
+        view.toWorld(gl.x, gl.y, world.x, world.y);
+        return gl_to_screen(world);
+    }
+
+    // Index of the nearest control point within POINT_THRESHOLD window pixels, or -1
+    int point_near(float x, float y, int exclude = -1) const {
+        return point_grid.nearest(x, y, POINT_THRESHOLD / view.scale, exclude);
+    }
+
+    // Uniform samples for the global Bezier at the given zoom: plotted points
+    // at most CURVE_POINT_SPACING apart (|B'| <= n * longest control edge) and
+    // the polyline within CURVE_TOLERANCE, both in window pixels
+    static int curve_steps_on_screen(const std::vector<Point>& points, float scale) {
+        int n = static_cast<int>(points.size()) - 1;
+        float longest_edge = 0.0f;
+        for (int i = 0; i < n; ++i) {
+            float dx = points[i + 1].x - points[i].x, dy = points[i + 1].y - points[i].y;
+            longest_edge = std::max(longest_edge, std::sqrt(dx * dx + dy * dy));
+        }
+        float spaced = std::ceil(n * longest_edge * scale / CURVE_POINT_SPACING);
+        int steps = bezierSegmentsForTolerance(point_floats(points), n + 1, scale, scale, CURVE_TOLERANCE,
+            MIN_CURVE_STEPS, MAX_CURVE_STEPS);
+        return static_cast<int>(std::min(static_cast<float>(MAX_CURVE_STEPS), std::max(static_cast<float>(steps), spaced)));
+    }
+
+    // One resolution for every composite segment, enough for the largest one at the given zoom
+    int segment_resolution_on_screen(const std::vector<Point>& points, float scale) const {
+        int count = static_cast<int>(points.size());
+        int resolution = MIN_SEGMENT_RESOLUTION;
+        float bezier[8];
+        for (int s = 0; s < composite.segmentCountFor(count); ++s) {
+            composite.segmentBezier(point_floats(points), count, s, bezier);
+            resolution = std::max(resolution, bezierSegmentsForTolerance(bezier, 4, scale, scale, CURVE_TOLERANCE,
+                MIN_SEGMENT_RESOLUTION, MAX_SEGMENT_RESOLUTION));
+        }
+        return resolution;
     }
 
     // De Casteljau's algorithm
-    void compute_point(float t) {
-        std::vector<Point> temp = control_points;
-        for (size_t k = 1; k < control_points.size(); ++k) {
-            for (size_t i = 0; i < control_points.size() - k; ++i) {
+    static void compute_point(const std::vector<Point>& points, float t, std::vector<Point>& out) {
+        std::vector<Point> temp = points;
+        for (size_t k = 1; k < points.size(); ++k) {
+            for (size_t i = 0; i < points.size() - k; ++i) {
                 temp[i] = temp[i] * (1 - t) + temp[i + 1] * t;
             }
         }
         if (!temp.empty()) {
-            curve_points.push_back(temp[0]);
+            out.push_back(temp[0]);
+        }
+    }
+
+    // Copy vertices [first, last] of the composite polyline into curve_points
+    void copy_composite_vertices(int first, int last) {
+        const std::vector<float>& vertices = composite.vertices();
+        curve_points.resize(vertices.size() / 2);
+        std::copy(vertices.begin() + first * 2, vertices.begin() + (last + 1) * 2, point_floats(curve_points) + first * 2);
+        convert_curve(first, last);
+    }
+
+    // Convert curve vertices [first, last] to GL coordinates and mark them for upload
+    void convert_curve(int first, int last) {
+        curve_gl_points.resize(curve_points.size());
+        for (int i = first; i <= last; ++i) {
+            curve_gl_points[i] = screen_to_gl(curve_points[i]);
+        }
+        if (curve_dirty_first > curve_dirty_last) {
+            curve_dirty_first = first;
+            curve_dirty_last = last;
+        }
+        else {
+            curve_dirty_first = std::min(curve_dirty_first, first);
+            curve_dirty_last = std::max(curve_dirty_last, last);
+        }
+    }
+
+    // Upload whatever changed since the last frame
+    void upload_curve() {
+        if (curve_dirty_first > curve_dirty_last) return;
+        glBindBuffer(GL_ARRAY_BUFFER, curve_buffer);
+        if (curve_gl_points.size() > curve_capacity) {
+            // Storage only grows; the whole curve is rewritten
+            curve_capacity = curve_gl_points.size();
+            glBufferData(GL_ARRAY_BUFFER, curve_capacity * sizeof(Point), curve_gl_points.data(), GL_DYNAMIC_DRAW);
         }
+        else {
+            glBufferSubData(GL_ARRAY_BUFFER, curve_dirty_first * sizeof(Point),
+                (curve_dirty_last - curve_dirty_first + 1) * sizeof(Point), &curve_gl_points[curve_dirty_first]);
+        }
+        curve_dirty_first = 0;
+        curve_dirty_last = -1;
+    }
+
+    void upload_controls() {
+        if (!control_points_dirty) return;
+        point_centers.clear();
+        for (auto it = control_points.begin(); it != control_points.end(); ++it) {
+            Point p = (is_moving && it == move_iter && !moving_points.empty())
+                ? moving_points.back() : *it;
+            Point gl_p = screen_to_gl(p);
+            point_centers.push_back(gl_p.x);
+            point_centers.push_back(gl_p.y);
+        }
+        point_renderer.setPoints(point_centers.data(), static_cast<int>(point_centers.size() / 2));
+        glBindBuffer(GL_ARRAY_BUFFER, control_buffer);
+        glBufferData(GL_ARRAY_BUFFER, point_centers.size() * sizeof(float), point_centers.data(), GL_DYNAMIC_DRAW);
+        control_points_dirty = false;
+    }
+
+    void draw_buffer(GLuint buffer, GLenum mode, int count, const Color& color) {
+        glUseProgram(program);
+        setViewUniform(program, view);
+        glUniform3f(glGetUniformLocation(program, "uColor"), color.r, color.g, color.b);
+        glBindVertexArray(vao);
+        glBindBuffer(GL_ARRAY_BUFFER, buffer);
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), nullptr);
+        glDrawArrays(mode, 0, count);
+        glBindVertexArray(0);
+    }
+
+    // Sparse polylines are drawn as lines rather than individual points
+    bool curve_is_polyline() const {
+        return basis != CurveBasis::GlobalBezier || engine == CurveEngine::Adaptive ||
+            engine == CurveEngine::ArcLength;
     }
 
 public:
-    void compute_curve() {
-        curve_points.clear();
-        if (control_points.size() >= 2) {
-            for (float t = 0; t <= 1.0f; t += CURVE_STEP) {
-                compute_point(t);
+    void init_gl() {
+        // A finished curve wakes the main loop out of glfwWaitEvents
+        tessellator.setReadyCallback([] { glfwPostEmptyEvent(); });
+        program = createProgram(VERTEX_SHADER, FRAGMENT_SHADER);
+        glGenVertexArrays(1, &vao);
+        glGenBuffers(1, &curve_buffer);
+        glGenBuffers(1, &control_buffer);
+        glBindVertexArray(vao);
+        glEnableVertexAttribArray(0);
+        glBindVertexArray(0);
+        point_renderer.init();
+    }
+
+    void destroy_gl() {
+        // No more wake-ups once GLFW is gone
+        tessellator.wait();
+        tessellator.setReadyCallback(nullptr);
+        point_renderer.destroy();
+        glDeleteBuffers(1, &curve_buffer);
+        glDeleteBuffers(1, &control_buffer);
+        glDeleteVertexArrays(1, &vao);
+        glDeleteProgram(program);
+    }
+
+    // Post the current control points to the worker; clearing also cancels the running job
+    void compute_curve(bool superseding = false) {
+        control_points_dirty = true;
+        std::vector<Point> points = control_points;
+        CurveEngine job_engine = engine;
+        CurveBasis job_basis = basis;
+        float job_scale = view.scale;
+        tessellator.post([this, points, job_engine, job_basis, job_scale](std::vector<Point>& out,
+            const CancelToken& token) {
+            return compute_curve_points(points, job_engine, job_basis, job_scale, out, token);
+        }, superseding);
+    }
+
+    // Runs on the worker, sampled for the zoom scale; returns false if a newer edit cancelled it
+    bool compute_curve_points(const std::vector<Point>& points, CurveEngine curve_engine, CurveBasis curve_basis,
+        float scale, std::vector<Point>& out, const CancelToken& token) {
+        out.clear();
+        if (points.size() < 2) return true;
+
+        if (curve_basis != CurveBasis::GlobalBezier) {
+            composite.setBasis(curve_basis);
+            composite.setSegmentResolution(segment_resolution_on_screen(points, scale));
+            composite.rebuild(point_floats(points), static_cast<int>(points.size()));
+            const std::vector<float>& vertices = composite.vertices();
+            out.resize(vertices.size() / 2);
+            std::copy(vertices.begin(), vertices.end(), point_floats(out));
+            return !token.cancelled();
+        }
+
+        int steps = curve_steps_on_screen(points, scale);
+        float step = 1.0f / steps;
+        float tolerance = CURVE_TOLERANCE / scale; // canvas pixels
+        if (curve_engine == CurveEngine::Simd) {
+            simd_evaluator.setControlPoints(point_floats(points), static_cast<int>(points.size()));
+            out.resize(steps + 1);
+            simd_evaluator.evaluateUniform(steps, point_floats(out), step);
+        }
+        else if (curve_engine == CurveEngine::BernsteinMatrix) {
+            std::shared_ptr<const BernsteinTable> table =
+                sharedBernsteinCache().get(static_cast<int>(points.size()) - 1, steps + 1);
+            out.resize(steps + 1);
+            tessellateWithBasis(*table, point_floats(points), point_floats(out));
+        }
+        else if (curve_engine == CurveEngine::Parallel) {
+            out.resize(steps + 1);
+            parallel_tessellator.tessellate(point_floats(points), static_cast<int>(points.size()),
+                steps, step, point_floats(out));
+        }
+        else if (curve_engine == CurveEngine::Specialized) {
+            dispatch_scratch.resize(2 * points.size());
+            out.resize(steps + 1);
+            evaluateBezierDispatch(point_floats(points), static_cast<int>(points.size()), 2,
+                steps, point_floats(out), dispatch_scratch.data());
+        }
+        else if (curve_engine == CurveEngine::Adaptive) {
+            adaptive_tessellator.tessellate(point_floats(points), static_cast<int>(points.size()),
+                tolerance, adaptive_points);
+            out.resize(adaptive_points.size() / 2);
+            std::copy(adaptive_points.begin(), adaptive_points.end(), point_floats(out));
+        }
+        else if (curve_engine == CurveEngine::ArcLength) {
+            // Evenly spaced along the curve, never more vertices than the fixed step
+            arc_length_table.setControlPoints(point_floats(points), static_cast<int>(points.size()));
+            int segments = arc_length_table.segmentsForTolerance(tolerance, 1, steps);
+            arc_length_table.tessellateEvenly(segments, arc_length_points);
+            out.resize(arc_length_points.size() / 2);
+            std::copy(arc_length_points.begin(), arc_length_points.end(), point_floats(out));
+        }
+        else {
+            out.reserve(steps + 1);
+            for (int i = 0; i <= steps && !token.cancelled(); ++i) {
+                compute_point(points, i * step, out);
+            }
+        }
+        return !token.cancelled();
+    }
+
+    // Swap in the worker's newest curve; true if one finished since the last call
+    bool collect_curve() {
+        if (!tessellator.takeResult(finished_points)) return false;
+        curve_points.swap(finished_points);
+        convert_curve(0, static_cast<int>(curve_points.size()) - 1);
+        if (report_curve) {
+            report_curve = false;
+            std::cout << "  " << curve_points.size() << " vertices";
+            bool uniform = engine != CurveEngine::Adaptive && engine != CurveEngine::ArcLength;
+            if (!uniform && basis == CurveBasis::GlobalBezier && control_points.size() >= 2) {
+                std::cout << " (fixed step: " << curve_steps_on_screen(control_points, view.scale) + 1 << ")";
             }
+            std::cout << std::endl;
         }
+        return true;
+    }
+
+    // Whether the worker is done and curve_points shows its last job
+    bool curve_settled() {
+        if (!tessellator.idle()) return false;
+        collect_curve();
+        return true;
     }
 
     void draw_controls() {
+        upload_controls();
+
         // Draw control lines
         if (control_points.size() >= 2) {
             glLineWidth(1.0f);
-            glBegin(GL_LINE_STRIP);
-            glColor3f(CONTROL_LINE.r, CONTROL_LINE.g, CONTROL_LINE.b);
-            for (const auto& p : control_points) {
-                Point gl_p = screen_to_gl(p);
-                glVertex2f(gl_p.x, gl_p.y);
-            }
-            glEnd();
+            draw_buffer(control_buffer, GL_LINE_STRIP, static_cast<int>(control_points.size()), CONTROL_LINE);
         }
 
         // Draw control points
         if (!control_points.empty()) {
-            glPointSize(15.0f);
-            glBegin(GL_POINTS);
-            glColor3f(CONTROL_POINT.r, CONTROL_POINT.g, CONTROL_POINT.b);
-            for (auto it = control_points.begin(); it != control_points.end(); ++it) {
-                Point p = (is_moving && it == move_iter && !moving_points.empty())
-                    ? moving_points.back() : *it;
-                Point gl_p = screen_to_gl(p);
-                glVertex2f(gl_p.x, gl_p.y);
-            }
-            glEnd();
+            float radius = CONTROL_POINT_SIZE / HEIGHT; // half the diameter, in GL units
+            point_renderer.setView(view);
+            point_renderer.draw(radius, WIDTH / HEIGHT, CONTROL_POINT.r, CONTROL_POINT.g, CONTROL_POINT.b);
         }
     }
 
     void draw_curve() {
         if (!curve_points.empty()) {
+            upload_curve();
+            // Adaptive vertices are sparse, so join them instead of plotting each one
             glPointSize(5.0f);
-            glBegin(GL_POINTS);
-            glColor3f(CURVE.r, CURVE.g, CURVE.b);
-            for (const auto& p : curve_points) {
-                Point gl_p = screen_to_gl(p);
-                glVertex2f(gl_p.x, gl_p.y);
-            }
-            glEnd();
+            glLineWidth(5.0f);
+            draw_buffer(curve_buffer, curve_is_polyline() ? GL_LINE_STRIP : GL_POINTS,
+                static_cast<int>(curve_points.size()), CURVE);
         }
     }
 
-    void handle_mouse_press(float x, float y, int button) {
+    // Mouse handlers take window pixels
+    void handle_mouse_press(float window_x, float window_y, int button) {
+        if (button == GLFW_MOUSE_BUTTON_MIDDLE) {
+            is_panning = true;
+            pan_anchor = screen_to_gl({ window_x, window_y });
+            return;
+        }
+        Point p = window_to_canvas({ window_x, window_y });
+        float x = p.x, y = p.y;
         if (button == GLFW_MOUSE_BUTTON_LEFT && !is_moving) {
             // Check if we're clicking near an existing point
-            for (auto it = control_points.begin(); it != control_points.end(); ++it) {
-                if (is_close(*it, { x, y })) {
-                    is_moving = true;
-                    move_iter = it;
-                    moving_points.emplace_back(x, y);
-                    return;
-                }
+            int index = point_near(x, y);
+            if (index != -1) {
+                is_moving = true;
+                move_iter = control_points.begin() + index;
+                moving_points.emplace_back(x, y);
+                control_points_dirty = true;
+                return;
             }
         }
         else if (button == GLFW_MOUSE_BUTTON_RIGHT) {
             // Right click - try to delete a point
-            for (auto it = control_points.begin(); it != control_points.end(); ++it) {
-                if (is_close(*it, { x, y })) {
-                    control_points.erase(it);
-                    compute_curve();
-                    return;
-                }
+            // A piecewise Bezier loses a whole segment's worth of points
+            int index = point_near(x, y);
+            int first;
+            int erased = index != -1 ? compositeEraseRange(basis, static_cast<int>(control_points.size()), index, first) : 0;
+            if (erased == 1) {
+                control_points.erase(control_points.begin() + index);
+                point_grid.erase(index);
+                compute_curve();
+            }
+            else if (erased > 1) {
+                control_points.erase(control_points.begin() + first, control_points.begin() + first + erased);
+                point_grid.build(point_floats(control_points), static_cast<int>(control_points.size()));
+                compute_curve();
             }
         }
     }
 
-    void handle_mouse_release(float x, float y, int button) {
+    void handle_mouse_release(float window_x, float window_y, int button) {
+        if (button == GLFW_MOUSE_BUTTON_MIDDLE) {
+            is_panning = false;
+            return;
+        }
+        Point p = window_to_canvas({ window_x, window_y });
+        float x = p.x, y = p.y;
         if (button == GLFW_MOUSE_BUTTON_LEFT) {
             if (is_moving) {
-                move_iter->x = x;
-                move_iter->y = y;
+                int index = static_cast<int>(move_iter - control_points.begin());
+                int target = snapping ? point_near(x, y, index) : -1;
+                *move_iter = target != -1 ? control_points[target] : Point(x, y);
+                point_grid.move(index, move_iter->x, move_iter->y);
                 is_moving = false;
                 moving_points.clear();
+                control_points_dirty = true;
+
+                // Composite curves only retessellate the segments the point supports
+                int first, last;
+                if (basis != CurveBasis::GlobalBezier && curve_settled() && !curve_points.empty()) {
+                    if (composite.updatePoint(point_floats(control_points), index, first, last)) {
+                        copy_composite_vertices(first, last);
+                    }
+                    return;
+                }
             }
             else {
-                // Add new control point
+                // Add new control point; a piecewise Bezier gets a straight
+                // segment to it, handles at the thirds
+                if (compositeAppendCount(basis, static_cast<int>(control_points.size())) == 3) {
+                    Point last = control_points.back();
+                    for (int k = 1; k < 3; ++k) {
+                        Point handle(last.x + (x - last.x) * k / 3.0f, last.y + (y - last.y) * k / 3.0f);
+                        control_points.push_back(handle);
+                        point_grid.insert(point_grid.size(), handle.x, handle.y);
+                    }
+                }
                 control_points.emplace_back(x, y);
+                point_grid.insert(point_grid.size(), x, y);
             }
             compute_curve();
         }
     }
 
+    // Middle drag: only the view uniform changes, the samples stay valid
+    void handle_pan(float window_x, float window_y) {
+        Point gl = screen_to_gl({ window_x, window_y });
+        view.pan(gl.x - pan_anchor.x, gl.y - pan_anchor.y);
+        pan_anchor = gl;
+    }
+
+    // Zoom about the cursor; the curve is resampled for the new scale
+    void handle_scroll(float window_x, float window_y, float offset) {
+        float factor = std::pow(1.2f, offset);
+        factor = std::min(MAX_ZOOM, std::max(MIN_ZOOM, view.scale * factor)) / view.scale;
+        if (factor == 1.0f) return;
+        Point gl = screen_to_gl({ window_x, window_y });
+        view.zoomAt(gl.x, gl.y, factor);
+        compute_curve();
+    }
+
     void handle_key(int key, int action) {
-        if (key == GLFW_KEY_DELETE) {
+        if (key == GLFW_KEY_E && action == GLFW_PRESS) {
+            engine = static_cast<CurveEngine>((static_cast<int>(engine) + 1) % static_cast<int>(CurveEngine::Count));
+            std::cout << "Curve engine: " << curve_engine_name(engine) << std::endl;
+            report_curve = true;
+            compute_curve(true); // the running job is for the old engine
+        }
+        else if (key == GLFW_KEY_B && action == GLFW_PRESS) {
+            basis = static_cast<CurveBasis>((static_cast<int>(basis) + 1) % static_cast<int>(CurveBasis::Count));
+            std::cout << "Curve basis: " << curveBasisName(basis) << std::endl;
+            compute_curve();
+        }
+        else if (key == GLFW_KEY_HOME && action == GLFW_PRESS) {
+            view = ViewTransform();
+            std::cout << "View reset" << std::endl;
+            compute_curve();
+        }
+        else if (key == GLFW_KEY_N && action == GLFW_PRESS) {
+            snapping = !snapping;
+            std::cout << "Snap to points " << (snapping ? "ON" : "OFF") << std::endl;
+        }
+        else if (key == GLFW_KEY_DELETE) {
             is_deleting = (action == GLFW_PRESS);
         }
         else if (key == GLFW_KEY_ENTER && action == GLFW_PRESS) {
             control_points.clear();
+            point_grid.clear();
             moving_points.clear();
             curve_points.clear();
             is_moving = false;
             is_deleting = false;
+            compute_curve(true); // the old curve must not come back
         }
         else if (key == GLFW_KEY_SPACE && action == GLFW_PRESS) {
             control_points.clear();
+            point_grid.clear();
             moving_points.clear();
             curve_points.clear();
             is_moving = false;
             is_deleting = false;
+            compute_curve(true); // the old curve must not come back
         }
     }
 
     bool is_moving_state() const { return is_moving; }
+    bool is_panning_state() const { return is_panning; }
 };
 
 int main() {
@@ -193,7 +613,13 @@ int main() {
     glfwSetWindowPos(window, 600, 200);
     glfwMakeContextCurrent(window);
 
+    if (glewInit() != GLEW_OK) {
+        glfwTerminate();
+        return -1;
+    }
+
     BezierCurve curve;
+    curve.init_gl();
 
     glfwSetMouseButtonCallback(window, [](GLFWwindow* win, int button, int action, int mods) {
         static BezierCurve* curve_ptr = nullptr;
@@ -202,19 +628,27 @@ int main() {
         double x, y;
         glfwGetCursorPos(win, &x, &y);
 
+        needs_redraw = true;
         if (action == GLFW_PRESS) {
             curve_ptr->handle_mouse_press(static_cast<float>(x), static_cast<float>(y), button);
         }
-        else if (action == GLFW_RELEASE && button == GLFW_MOUSE_BUTTON_LEFT) {
+        else if (action == GLFW_RELEASE) {
             curve_ptr->handle_mouse_release(static_cast<float>(x), static_cast<float>(y), button);
         }
         });
 
     glfwSetCursorPosCallback(window, [](GLFWwindow* win, double x, double y) {
+        static BezierCurve* pan_ptr = nullptr;
+        if (!pan_ptr) pan_ptr = static_cast<BezierCurve*>(glfwGetWindowUserPointer(win));
+        if (pan_ptr->is_panning_state()) {
+            needs_redraw = true;
+            pan_ptr->handle_pan(static_cast<float>(x), static_cast<float>(y));
+        }
         if (glfwGetMouseButton(win, GLFW_MOUSE_BUTTON_LEFT) == GLFW_PRESS) {
             static BezierCurve* curve_ptr = nullptr;
             if (!curve_ptr) curve_ptr = static_cast<BezierCurve*>(glfwGetWindowUserPointer(win));
             if (curve_ptr->is_moving_state()) {
+                needs_redraw = true;
                 curve_ptr->handle_mouse_press(static_cast<float>(x), static_cast<float>(y), GLFW_MOUSE_BUTTON_LEFT);
             }
         }
@@ -224,11 +658,38 @@ int main() {
         static BezierCurve* curve_ptr = nullptr;
         if (!curve_ptr) curve_ptr = static_cast<BezierCurve*>(glfwGetWindowUserPointer(win));
         curve_ptr->handle_key(key, action);
+        needs_redraw = true;
+        });
+
+    glfwSetScrollCallback(window, [](GLFWwindow* win, double, double yoffset) {
+        static BezierCurve* curve_ptr = nullptr;
+        if (!curve_ptr) curve_ptr = static_cast<BezierCurve*>(glfwGetWindowUserPointer(win));
+        double x, y;
+        glfwGetCursorPos(win, &x, &y);
+        curve_ptr->handle_scroll(static_cast<float>(x), static_cast<float>(y), static_cast<float>(yoffset));
+        needs_redraw = true;
+        });
+
+    glfwSetWindowRefreshCallback(window, [](GLFWwindow*) {
+        needs_redraw = true;
         });
 
     glfwSetWindowUserPointer(window, &curve);
 
+    // Control points are blended at their anti-aliased edge
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
     while (!glfwWindowShouldClose(window)) {
+        if (curve.collect_curve()) {
+            needs_redraw = true;
+        }
+        if (!needs_redraw) {
+            glfwWaitEvents();
+            continue;
+        }
+        needs_redraw = false;
+
         glClearColor(1.0f, 1.0f, 0.0f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT);
 
@@ -236,9 +697,9 @@ int main() {
         curve.draw_curve();
 
         glfwSwapBuffers(window);
-        glfwPollEvents();
     }
 
+    curve.destroy_gl();
     glfwTerminate();
     return 0;
 }
@@ -0,0 +1,179 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <cstring>
+#include <algorithm>
+
+// Where a block of streamed data ended up
+struct StreamAllocation {
+    GLintptr offset = 0;
+    unsigned frame = 0;      // frame it was written in
+    unsigned generation = 0; // storage it was written to
+    bool valid = false;
+};
+
+// Ring buffer for per-edit vertex data.
+//
+// With GL_ARB_buffer_storage the whole buffer is mapped once, persistently and
+// coherently, and split into REGION_COUNT regions, one per frame in flight.
+// beginFrame() waits on the fence of the region it is about to reuse, write()
+// suballocates from that region with a memcpy, and endFrame() fences it. The
+// driver never reallocates and nothing is copied twice. A region's fence only
+// covers the draws of the frame that wrote it, so its blocks are only live in
+// that frame and everything drawn is written again every frame.
+//
+// Without buffer storage, write() appends with glBufferSubData and reserve()
+// orphans the buffer with glBufferData(nullptr) when a frame's data does not
+// fit behind the cursor, so the driver can hand out fresh memory instead of
+// stalling on pending draws. Blocks stay live across frames until then.
+//
+// Callers reserve() the frame's total before writing. A write that still runs
+// out of space grows the buffer, which drops every earlier allocation, so
+// isLive() tells callers when data has to be written again.
+class StreamBuffer {
+public:
+    static const int REGION_COUNT = 3;
+    static const GLintptr ALIGNMENT = 16;
+
+    void init(GLsizeiptr regionBytes = 1 << 20) {
+        persistent = GLEW_ARB_buffer_storage || GLEW_VERSION_4_4;
+        allocate(regionBytes);
+    }
+
+    void destroy() {
+        release();
+    }
+
+    bool isPersistent() const { return persistent; }
+    GLuint buffer() const { return name; }
+
+    void beginFrame() {
+        ++frame;
+        if (!persistent) return;
+        region = frame % REGION_COUNT;
+        waitForRegion(region);
+        cursor = 0;
+    }
+
+    void endFrame() {
+        if (!persistent) return;
+        if (fences[region]) glDeleteSync(fences[region]);
+        fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+
+    // Bytes a write of bytes takes up, padding included
+    static GLsizeiptr alignedSize(GLsizeiptr bytes) {
+        return (bytes + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+    }
+
+    // Make room for bytes (a sum of alignedSize()s) behind the cursor. If they
+    // do not fit, the buffer is orphaned or grown and every earlier allocation
+    // dies, so call it before the frame's first write with everything the
+    // frame may write, live blocks included.
+    void reserve(GLsizeiptr bytes) {
+        if (cursor + bytes <= regionSize) return;
+        if (persistent || bytes > regionSize) {
+            grow(bytes);
+            return;
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, name);
+        glBufferData(GL_ARRAY_BUFFER, regionSize, nullptr, GL_STREAM_DRAW);
+        ++generation;
+        cursor = 0;
+    }
+
+    // Copy bytes into the buffer and return where they went
+    StreamAllocation write(const void* data, GLsizeiptr bytes) {
+        GLsizeiptr aligned = alignedSize(bytes);
+        if (cursor + aligned > regionSize) {
+            // Not reserved: earlier blocks are lost, callers rewrite through isLive()
+            grow(aligned);
+        }
+
+        StreamAllocation result;
+        result.offset = (persistent ? region * regionSize : 0) + cursor;
+        result.frame = frame;
+        result.generation = generation;
+        result.valid = true;
+        if (persistent) {
+            std::memcpy(mapped + result.offset, data, bytes);
+        }
+        else {
+            glBindBuffer(GL_ARRAY_BUFFER, name);
+            glBufferSubData(GL_ARRAY_BUFFER, result.offset, bytes, data);
+        }
+        cursor += aligned;
+        return result;
+    }
+
+    bool isLive(const StreamAllocation& allocation) const {
+        if (!allocation.valid || allocation.generation != generation) return false;
+        return !persistent || allocation.frame == frame;
+    }
+
+private:
+    bool persistent = false;
+    GLuint name = 0;
+    char* mapped = nullptr;
+    GLsizeiptr regionSize = 0;
+    GLintptr cursor = 0;
+    unsigned frame = 0;
+    unsigned generation = 0;
+    int region = 0;
+    GLsync fences[REGION_COUNT] = {};
+
+    void waitForRegion(int index) {
+        if (!fences[index]) return;
+        for (;;) {
+            GLenum status = glClientWaitSync(fences[index], GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+            if (status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED || status == GL_WAIT_FAILED) break;
+        }
+        glDeleteSync(fences[index]);
+        fences[index] = nullptr;
+    }
+
+    // At least doubles the storage, so rewriting what was lost converges
+    void grow(GLsizeiptr bytes) {
+        allocate(std::max(bytes, 2 * regionSize));
+        if (persistent) region = frame % REGION_COUNT;
+    }
+
+    void release() {
+        for (int i = 0; i < REGION_COUNT; ++i) {
+            waitForRegion(i);
+        }
+        if (mapped) {
+            glBindBuffer(GL_ARRAY_BUFFER, name);
+            glUnmapBuffer(GL_ARRAY_BUFFER);
+            mapped = nullptr;
+        }
+        if (name) glDeleteBuffers(1, &name);
+        name = 0;
+    }
+
+    void allocate(GLsizeiptr bytes) {
+        release();
+        regionSize = (bytes + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+        cursor = 0;
+        ++generation;
+
+        glGenBuffers(1, &name);
+        glBindBuffer(GL_ARRAY_BUFFER, name);
+        if (persistent) {
+            GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+            glBufferStorage(GL_ARRAY_BUFFER, regionSize * REGION_COUNT, nullptr, flags);
+            mapped = (char*)glMapBufferRange(GL_ARRAY_BUFFER, 0, regionSize * REGION_COUNT, flags);
+            if (mapped) return;
+
+            // Immutable storage cannot be respecified, so start over with a mutable buffer
+            persistent = false;
+            glDeleteBuffers(1, &name);
+            glGenBuffers(1, &name);
+            glBindBuffer(GL_ARRAY_BUFFER, name);
+            glBufferData(GL_ARRAY_BUFFER, regionSize, nullptr, GL_STREAM_DRAW);
+        }
+        else {
+            glBufferData(GL_ARRAY_BUFFER, regionSize, nullptr, GL_STREAM_DRAW);
+        }
+    }
+};
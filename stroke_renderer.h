@@ -0,0 +1,214 @@
+#pragma once
+
+#include <GL/glew.h>
+#include "shader_utils.h"
+#include "view_transform.h"
+
+// How consecutive stroke segments are connected
+enum class StrokeJoin {
+    Miter,
+    Round,
+    Bevel,
+    Count
+};
+
+// How the two open ends of a stroke are finished
+enum class StrokeCap {
+    Butt,
+    Square,
+    Round,
+    Count
+};
+
+inline const char* strokeJoinName(StrokeJoin join) {
+    switch (join) {
+    case StrokeJoin::Miter: return "Miter";
+    case StrokeJoin::Round: return "Round";
+    case StrokeJoin::Bevel: return "Bevel";
+    default: return "Unknown";
+    }
+}
+
+inline const char* strokeCapName(StrokeCap cap) {
+    switch (cap) {
+    case StrokeCap::Butt: return "Butt";
+    case StrokeCap::Square: return "Square";
+    case StrokeCap::Round: return "Round";
+    default: return "Unknown";
+    }
+}
+
+// Thick polylines expanded entirely in the vertex shader.
+//
+// The polyline stays in whatever buffer already holds it: the shader pulls
+// the points through a buffer texture, so nothing is rebuilt or re-uploaded
+// when the width, join or cap changes. Three instanced passes draw one quad
+// per segment, one join per interior point, and round caps at the two ends;
+// square caps just extend the end segments. All geometry is built in window
+// pixels, so widths are in pixels regardless of the aspect ratio.
+class StrokeRenderer {
+public:
+    static const int FAN_TRIANGLES = 16; // round joins and caps
+    static constexpr float MITER_LIMIT = 4.0f; // must match MITER_LIMIT in vertexSource
+
+    // How far a stroke reaches past its polyline, in half widths: miter
+    // tips up to MITER_LIMIT, square cap corners the diagonal of a square
+    static float reach(StrokeJoin join, StrokeCap cap) {
+        if (join == StrokeJoin::Miter) return MITER_LIMIT;
+        return cap == StrokeCap::Square ? 1.41421356f : 1.0f;
+    }
+
+    void init() {
+        program = createProgram(vertexSource, fragmentSource);
+        glGenVertexArrays(1, &vao);
+        glGenTextures(1, &pointTexture);
+    }
+
+    void destroy() {
+        glDeleteTextures(1, &pointTexture);
+        glDeleteVertexArrays(1, &vao);
+        glDeleteProgram(program);
+    }
+
+    // World-to-screen mapping applied to every point; identity by default
+    void setView(const ViewTransform& transform) {
+        view = transform;
+    }
+
+    // Stroke count interleaved x/y points (GL coordinates) starting at vertex first of buffer
+    void draw(GLuint buffer, int first, int count, float width, StrokeJoin join, StrokeCap cap,
+        int viewportWidth, int viewportHeight, float r, float g, float b) {
+        if (count < 2) return;
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_BUFFER, pointTexture);
+        // Re-attached every draw: the stream buffer is replaced when it grows
+        glTexBuffer(GL_TEXTURE_BUFFER, GL_RG32F, buffer);
+
+        glUseProgram(program);
+        glUniform1i(glGetUniformLocation(program, "uPoints"), 0);
+        glUniform1i(glGetUniformLocation(program, "uFirst"), first);
+        glUniform1i(glGetUniformLocation(program, "uCount"), count);
+        glUniform2f(glGetUniformLocation(program, "uViewport"), (float)viewportWidth, (float)viewportHeight);
+        setViewUniform(program, view);
+        glUniform1f(glGetUniformLocation(program, "uHalfWidth"), 0.5f * width);
+        glUniform1i(glGetUniformLocation(program, "uJoin"), (int)join);
+        glUniform1i(glGetUniformLocation(program, "uCap"), (int)cap);
+        glUniform3f(glGetUniformLocation(program, "uColor"), r, g, b);
+        GLint pass = glGetUniformLocation(program, "uPass");
+
+        glBindVertexArray(vao);
+        glUniform1i(pass, 0);
+        glDrawArraysInstanced(GL_TRIANGLES, 0, 6, count - 1);
+
+        if (count > 2) {
+            int joinVertices = join == StrokeJoin::Round ? 3 * FAN_TRIANGLES : (join == StrokeJoin::Miter ? 6 : 3);
+            glUniform1i(pass, 1);
+            glDrawArraysInstanced(GL_TRIANGLES, 0, joinVertices, count - 2);
+        }
+        if (cap == StrokeCap::Round) {
+            glUniform1i(pass, 2);
+            glDrawArraysInstanced(GL_TRIANGLES, 0, 3 * FAN_TRIANGLES, 2);
+        }
+        glBindVertexArray(0);
+    }
+
+private:
+    GLuint program = 0;
+    GLuint vao = 0; // no attributes, but core profiles need one bound
+    GLuint pointTexture = 0;
+    ViewTransform view;
+
+    const char* vertexSource = R"(
+#version 330 core
+const int FAN_TRIANGLES = 16;
+const float MITER_LIMIT = 4.0;
+uniform samplerBuffer uPoints;
+uniform int uFirst;
+uniform int uCount;
+uniform vec2 uViewport;
+uniform vec4 uView;
+uniform float uHalfWidth;
+uniform int uPass; // 0 segments, 1 joins, 2 round caps
+uniform int uJoin; // StrokeJoin
+uniform int uCap;  // StrokeCap
+
+vec2 point(int i) {
+    vec2 p = texelFetch(uPoints, uFirst + i).xy * uView.xy + uView.zw;
+    return (p * 0.5 + 0.5) * uViewport;
+}
+
+vec2 direction(vec2 a, vec2 b) {
+    vec2 d = b - a;
+    float len = length(d);
+    return len > 1e-6 ? d / len : vec2(1.0, 0.0);
+}
+
+vec2 leftNormal(vec2 d) {
+    return vec2(-d.y, d.x);
+}
+
+// Corner of triangle tri of a disc around center
+vec2 fan(vec2 center, int tri, int corner) {
+    if (corner == 0) return center;
+    float angle = 6.2831853 * float(tri + corner - 1) / float(FAN_TRIANGLES);
+    return center + uHalfWidth * vec2(cos(angle), sin(angle));
+}
+
+vec2 segmentVertex(int i, int v) {
+    vec2 a = point(i);
+    vec2 b = point(i + 1);
+    vec2 d = direction(a, b);
+    if (uCap == 1) {
+        if (i == 0) a -= d * uHalfWidth;
+        if (i == uCount - 2) b += d * uHalfWidth;
+    }
+    // Two triangles: (a+, a-, b+) and (a-, b-, b+)
+    bool atEnd = v == 2 || v == 4 || v == 5;
+    bool left = v == 0 || v == 2 || v == 5;
+    vec2 n = leftNormal(d) * uHalfWidth;
+    return (atEnd ? b : a) + (left ? n : -n);
+}
+
+vec2 joinVertex(int j, int tri, int corner) {
+    vec2 p = point(j);
+    if (uJoin == 1) return fan(p, tri, corner);
+
+    // Fill the wedge on the outer side of the turn
+    vec2 d0 = direction(point(j - 1), p);
+    vec2 d1 = direction(p, point(j + 1));
+    float side = d0.x * d1.y - d0.y * d1.x > 0.0 ? -1.0 : 1.0;
+    vec2 n0 = side * leftNormal(d0);
+    vec2 n1 = side * leftNormal(d1);
+    if (tri == 0) {
+        return corner == 0 ? p : p + uHalfWidth * (corner == 1 ? n0 : n1);
+    }
+
+    // Miter tip, dropped back to the bevel past the miter limit
+    vec2 m = n0 + n1;
+    float len = length(m);
+    float scale = len > 1e-6 ? len / dot(m, n0) : MITER_LIMIT + 1.0;
+    if (scale > MITER_LIMIT) return p;
+    vec2 tip = p + uHalfWidth * scale * m / len;
+    return corner == 0 ? p + uHalfWidth * n0 : (corner == 1 ? tip : p + uHalfWidth * n1);
+}
+
+void main() {
+    int tri = gl_VertexID / 3;
+    int corner = gl_VertexID - tri * 3;
+    vec2 pos;
+    if (uPass == 0) pos = segmentVertex(gl_InstanceID, gl_VertexID);
+    else if (uPass == 1) pos = joinVertex(gl_InstanceID + 1, tri, corner);
+    else pos = fan(point(gl_InstanceID == 0 ? 0 : uCount - 1), tri, corner);
+    gl_Position = vec4(pos / uViewport * 2.0 - 1.0, 0.0, 1.0);
+}
+)";
+
+    const char* fragmentSource = R"(
+#version 330 core
+uniform vec3 uColor;
+out vec4 FragColor;
+void main() {
+    FragColor = vec4(uColor, 1.0);
+}
+)";
+};
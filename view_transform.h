@@ -0,0 +1,44 @@
+#pragma once
+
+#include <GL/glew.h>
+
+// 2D pan/zoom camera. Curves live in world coordinates; the screen, in GL
+// coordinates, shows world * scale + offset. Shaders take the same mapping
+// as a vec4 uView = (scale, scale, offsetX, offsetY).
+struct ViewTransform {
+    float scale = 1.0f;
+    float offsetX = 0.0f;
+    float offsetY = 0.0f;
+
+    void toScreen(float x, float y, float& screenX, float& screenY) const {
+        screenX = x * scale + offsetX;
+        screenY = y * scale + offsetY;
+    }
+
+    void toWorld(float screenX, float screenY, float& x, float& y) const {
+        x = (screenX - offsetX) / scale;
+        y = (screenY - offsetY) / scale;
+    }
+
+    // Zoom by factor, keeping the world point under (screenX, screenY) in place
+    void zoomAt(float screenX, float screenY, float factor) {
+        offsetX = screenX - (screenX - offsetX) * factor;
+        offsetY = screenY - (screenY - offsetY) * factor;
+        scale *= factor;
+    }
+
+    void pan(float screenDX, float screenDY) {
+        offsetX += screenDX;
+        offsetY += screenDY;
+    }
+
+    // World rectangle that maps onto the [-1, 1] viewport
+    void visibleRect(float& minX, float& minY, float& maxX, float& maxY) const {
+        toWorld(-1.0f, -1.0f, minX, minY);
+        toWorld(1.0f, 1.0f, maxX, maxY);
+    }
+};
+
+inline void setViewUniform(GLuint program, const ViewTransform& view) {
+    glUniform4f(glGetUniformLocation(program, "uView"), view.scale, view.scale, view.offsetX, view.offsetY);
+}